@@ -0,0 +1,493 @@
+#include "tte.h"
+
+// Saved animations (--save / --play). A file is a fixed header, an index
+// of every frame's record, an index of keyframe records, then the records
+// themselves, optionally LZ-compressed as one block:
+//
+//   "TTEA" u16 version, u16 flags, u16 rows, u16 cols, u32 frame_rate,
+//   u32 frame_count, u32 keyframe_count, u32 data_len, u32 stored_len
+//   frame_count    x (u32 frame, u32 record offset)
+//   keyframe_count x (u32 frame, u32 record offset)
+//   stored_len bytes of records (data_len once decompressed)
+//
+// A record is the dirty runs of one frame: u32 run count, then per run
+// u16 row, u16 col, u16 len and len cells. A cell is an attribute byte
+// (CELL_BOLD, CELL_FG, CELL_BG), the character, then the foreground and
+// background colors as one byte each, present only if they are not the
+// default. Frame records hold only what changed, like the live renderer;
+// keyframe records hold every non-blank cell of the screen every
+// ANIM_KEYFRAME_INTERVAL frames so playback can start mid-animation.
+// All integers are little-endian.
+
+#define CELL_BOLD 1
+#define CELL_FG 2
+#define CELL_BG 4
+
+static void put_u16(byte_buffer_t *out, unsigned int v) {
+    unsigned char b[2] = {v & 0xff, (v >> 8) & 0xff};
+    buffer_append(out, (const char *)b, 2);
+}
+
+static void put_u32(byte_buffer_t *out, uint32_t v) {
+    unsigned char b[4] = {v & 0xff, (v >> 8) & 0xff, (v >> 16) & 0xff, v >> 24};
+    buffer_append(out, (const char *)b, 4);
+}
+
+static unsigned int get_u16(const unsigned char *p) {
+    return p[0] | (p[1] << 8);
+}
+
+static uint32_t get_u32(const unsigned char *p) {
+    return p[0] | (p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+// frame_format_t for saving: the frame's dirty runs as a record
+void format_delta_frame(frame_slot_t *slot, config_t *config, byte_buffer_t *out) {
+    // Colors are applied at playback
+    double start = stats_start(config);
+    put_u32(out, slot->run_count);
+    for (int r = 0; r < slot->run_count; r++) {
+        screen_run_t *run = &slot->runs[r];
+        put_u16(out, run->row);
+        put_u16(out, run->col);
+        put_u16(out, run->len);
+        for (int j = 0; j < run->len; j++) {
+            int cell = run->cell + j;
+            unsigned char bytes[4];
+            int n = 2;
+            bytes[0] = slot->bold[cell] ? CELL_BOLD : 0;
+            bytes[1] = (unsigned char)slot->ch[cell];
+            if (slot->fg[cell] >= 0) {
+                bytes[0] |= CELL_FG;
+                bytes[n++] = (unsigned char)slot->fg[cell];
+            }
+            if (slot->bg[cell] >= 0) {
+                bytes[0] |= CELL_BG;
+                bytes[n++] = (unsigned char)slot->bg[cell];
+            }
+            buffer_append(out, (const char *)bytes, n);
+        }
+    }
+    if (config && config->stats) {
+        stats_stop(config, STAT_ENCODE, start);
+        stats_add(config->stats, STAT_CELLS, slot->cell_count);  // No escape codes until playback
+    }
+}
+
+// Parse the record at p into slot's runs. Returns -1 if it is malformed
+// or leaves the screen.
+static int decode_record(const unsigned char *p, const unsigned char *end, int rows, int cols,
+                         frame_slot_t *slot) {
+    slot->rows = rows;
+    slot->cols = cols;
+    slot->run_count = 0;
+    slot->cell_count = 0;
+    if (end - p < 4) {
+        return -1;
+    }
+    uint32_t run_count = get_u32(p);
+    p += 4;
+    for (uint32_t r = 0; r < run_count; r++) {
+        if (end - p < 6) {
+            return -1;
+        }
+        int row = get_u16(p);
+        int col = get_u16(p + 2);
+        int len = get_u16(p + 4);
+        p += 6;
+        if (row >= rows || col + len > cols) {
+            return -1;
+        }
+        if (!reserve_frame_slot(slot, slot->run_count + 1, slot->cell_count + len)) {
+            return -1;
+        }
+        screen_run_t *run = &slot->runs[slot->run_count++];
+        run->row = row;
+        run->col = col;
+        run->len = len;
+        run->cell = slot->cell_count;
+        for (int j = 0; j < len; j++) {
+            if (end - p < 2) {
+                return -1;
+            }
+            int cell = run->cell + j;
+            int attr = *p++;
+            slot->ch[cell] = (char)*p++;
+            slot->bold[cell] = attr & CELL_BOLD;
+            slot->fg[cell] = -1;
+            slot->bg[cell] = -1;
+            if (attr & CELL_FG) {
+                if (p >= end) {
+                    return -1;
+                }
+                slot->fg[cell] = *p++;
+            }
+            if (attr & CELL_BG) {
+                if (p >= end) {
+                    return -1;
+                }
+                slot->bg[cell] = *p++;
+            }
+        }
+        slot->cell_count += len;
+    }
+    return 0;
+}
+
+// What the terminal shows after the records applied so far
+static int init_screen(anim_screen_t *screen, int rows, int cols) {
+    size_t cells = (size_t)rows * cols;
+    screen->rows = rows;
+    screen->cols = cols;
+    screen->ch = malloc(cells ? cells : 1);
+    screen->fg = malloc((cells ? cells : 1) * sizeof(int));
+    screen->bg = malloc((cells ? cells : 1) * sizeof(int));
+    screen->bold = calloc(cells ? cells : 1, sizeof(int));
+    if (!screen->ch || !screen->fg || !screen->bg || !screen->bold) {
+        return -1;
+    }
+    memset(screen->ch, ' ', cells);
+    for (size_t i = 0; i < cells; i++) {
+        screen->fg[i] = -1;
+        screen->bg[i] = -1;
+    }
+    return 0;
+}
+
+static void free_screen(anim_screen_t *screen) {
+    free(screen->ch);
+    free(screen->fg);
+    free(screen->bg);
+    free(screen->bold);
+    memset(screen, 0, sizeof(*screen));
+}
+
+static void apply_slot(anim_screen_t *screen, const frame_slot_t *slot) {
+    for (int r = 0; r < slot->run_count; r++) {
+        const screen_run_t *run = &slot->runs[r];
+        size_t at = (size_t)run->row * screen->cols + run->col;
+        memcpy(screen->ch + at, slot->ch + run->cell, run->len);
+        memcpy(screen->fg + at, slot->fg + run->cell, run->len * sizeof(int));
+        memcpy(screen->bg + at, slot->bg + run->cell, run->len * sizeof(int));
+        memcpy(screen->bold + at, slot->bold + run->cell, run->len * sizeof(int));
+    }
+}
+
+static int blank_cell(const anim_screen_t *screen, size_t at) {
+    return screen->ch[at] == ' ' && screen->fg[at] < 0 && screen->bg[at] < 0 && !screen->bold[at];
+}
+
+// The screen as one run per row. With trim, runs skip the blank cells at
+// either end of their row and blank rows are left out, which is all a
+// keyframe needs since playback starts from a blank screen.
+static int screen_to_slot(const anim_screen_t *screen, frame_slot_t *slot, int trim) {
+    slot->rows = screen->rows;
+    slot->cols = screen->cols;
+    slot->run_count = 0;
+    slot->cell_count = 0;
+    if (!reserve_frame_slot(slot, screen->rows, screen->rows * screen->cols)) {
+        return -1;
+    }
+    for (int row = 0; row < screen->rows; row++) {
+        size_t line = (size_t)row * screen->cols;
+        int first = 0;
+        int last = screen->cols;
+        if (trim) {
+            while (first < last && blank_cell(screen, line + first)) {
+                first++;
+            }
+            while (last > first && blank_cell(screen, line + last - 1)) {
+                last--;
+            }
+            if (first == last) {
+                continue;
+            }
+        }
+        screen_run_t *run = &slot->runs[slot->run_count++];
+        run->row = row;
+        run->col = first;
+        run->len = last - first;
+        run->cell = slot->cell_count;
+        memcpy(slot->ch + run->cell, screen->ch + line + first, run->len);
+        memcpy(slot->fg + run->cell, screen->fg + line + first, run->len * sizeof(int));
+        memcpy(slot->bg + run->cell, screen->bg + line + first, run->len * sizeof(int));
+        memcpy(slot->bold + run->cell, screen->bold + line + first, run->len * sizeof(int));
+        slot->cell_count += run->len;
+    }
+    return 0;
+}
+
+int anim_writer_init(anim_writer_t *writer, int rows, int cols, int frame_rate, int compress) {
+    memset(writer, 0, sizeof(*writer));
+    writer->rows = rows;
+    writer->cols = cols;
+    writer->frame_rate = frame_rate;
+    writer->compress = compress;
+    writer->next_keyframe = INT_MIN;
+    return init_screen(&writer->screen, rows, cols);
+}
+
+// frame_output_t callback taking format_delta_frame records in frame order
+void anim_writer_frame(void *ctx, int frame, const char *data, size_t len) {
+    anim_writer_t *writer = ctx;
+    const unsigned char *record = (const unsigned char *)data;
+
+    put_u32(&writer->frames, frame);
+    put_u32(&writer->frames, writer->data.len);
+    buffer_append(&writer->data, data, len);
+    writer->frame_count++;
+
+    // Track the screen so keyframes can snapshot it
+    if (decode_record(record, record + len, writer->rows, writer->cols, &writer->slot) != 0) {
+        writer->failed = 1;
+        return;
+    }
+    apply_slot(&writer->screen, &writer->slot);
+    if (frame >= writer->next_keyframe) {
+        if (screen_to_slot(&writer->screen, &writer->slot, 1) != 0) {
+            writer->failed = 1;
+            return;
+        }
+        put_u32(&writer->keyframes, frame);
+        put_u32(&writer->keyframes, writer->data.len);
+        format_delta_frame(&writer->slot, NULL, &writer->data);
+        writer->keyframe_count++;
+        writer->next_keyframe = frame + ANIM_KEYFRAME_INTERVAL;
+    }
+}
+
+static void free_writer(anim_writer_t *writer) {
+    buffer_free(&writer->data);
+    buffer_free(&writer->frames);
+    buffer_free(&writer->keyframes);
+    free_frame_slot(&writer->slot);
+    free_screen(&writer->screen);
+}
+
+// Write the file atomically and release the writer. Returns -1 on failure.
+int anim_writer_finish(anim_writer_t *writer, const char *path) {
+    byte_buffer_t stored = {0};
+    const byte_buffer_t *body = &writer->data;
+    int failed = writer->failed || writer->data.len > UINT32_MAX;
+    if (!failed && writer->compress) {
+        failed = lz_compress(writer->data.data, writer->data.len, &stored) != 0;
+        body = &stored;
+    }
+
+    byte_buffer_t header = {0};
+    buffer_append(&header, ANIM_MAGIC, 4);
+    put_u16(&header, ANIM_VERSION);
+    put_u16(&header, writer->compress ? ANIM_FLAG_LZ : 0);
+    put_u16(&header, writer->rows);
+    put_u16(&header, writer->cols);
+    put_u32(&header, writer->frame_rate);
+    put_u32(&header, writer->frame_count);
+    put_u32(&header, writer->keyframe_count);
+    put_u32(&header, writer->data.len);
+    put_u32(&header, body->len);
+
+    // Write a private temporary file and rename it into place, so readers
+    // see either no file or a complete one. The name is unique even among
+    // writers in one process (daemon clients, batch jobs).
+    size_t temp_size = strlen(path) + 32;
+    char *temp = malloc(temp_size);
+    FILE *file = NULL;
+    if (!failed && temp) {
+        snprintf(temp, temp_size, "%s.tmp.XXXXXX", path);
+        int fd = mkstemp(temp);
+        if (fd >= 0) {
+            // mkstemp creates it owner-only; give it a regular file's mode
+            fchmod(fd, S_IRUSR | S_IWUSR | S_IRGRP | S_IROTH);
+            file = fdopen(fd, "wb");
+            if (!file) {
+                close(fd);
+                unlink(temp);
+            }
+        }
+    }
+    if (file) {
+        const byte_buffer_t *parts[] = {&header, &writer->frames, &writer->keyframes, body};
+        for (int k = 0; k < 4; k++) {
+            if (parts[k]->len && fwrite(parts[k]->data, 1, parts[k]->len, file) != parts[k]->len) {
+                failed = 1;
+            }
+        }
+        failed |= fclose(file) != 0;
+        if (failed || rename(temp, path) != 0) {
+            int saved = errno;
+            unlink(temp);
+            errno = saved;
+            failed = 1;
+        }
+    } else {
+        failed = 1;
+    }
+    free(temp);
+
+    buffer_free(&header);
+    buffer_free(&stored);
+    free_writer(writer);
+    return failed ? -1 : 0;
+}
+
+typedef struct {
+    int rows;
+    int cols;
+    int frame_rate;
+    uint32_t frame_count;
+    uint32_t keyframe_count;
+    const unsigned char *frames;
+    const unsigned char *keyframes;
+    const unsigned char *data;
+    size_t data_len;
+} anim_file_t;
+
+// Check the header and that every table fits in the mapping
+static int parse_anim(anim_file_t *anim, const unsigned char *map, size_t size, char **inflated) {
+    *inflated = NULL;
+    if (size < ANIM_HEADER_SIZE || memcmp(map, ANIM_MAGIC, 4) != 0 || get_u16(map + 4) != ANIM_VERSION) {
+        return -1;
+    }
+    int flags = get_u16(map + 6);
+    anim->rows = get_u16(map + 8);
+    anim->cols = get_u16(map + 10);
+    anim->frame_rate = (int)get_u32(map + 12);
+    anim->frame_count = get_u32(map + 16);
+    anim->keyframe_count = get_u32(map + 20);
+    uint32_t data_len = get_u32(map + 24);
+    uint32_t stored_len = get_u32(map + 28);
+
+    size_t tables = ((size_t)anim->frame_count + anim->keyframe_count) * 8;
+    if (anim->rows > MAX_LINES || anim->cols > MAX_COLS ||
+        tables > size - ANIM_HEADER_SIZE || stored_len > size - ANIM_HEADER_SIZE - tables) {
+        return -1;
+    }
+    anim->frames = map + ANIM_HEADER_SIZE;
+    anim->keyframes = anim->frames + (size_t)anim->frame_count * 8;
+    const unsigned char *stored = anim->keyframes + (size_t)anim->keyframe_count * 8;
+
+    if (flags & ANIM_FLAG_LZ) {
+        *inflated = malloc(data_len ? data_len : 1);
+        if (!*inflated || lz_decompress((const char *)stored, stored_len, *inflated, data_len) != 0) {
+            return -1;
+        }
+        anim->data = (const unsigned char *)*inflated;
+    } else {
+        if (stored_len != data_len) {
+            return -1;
+        }
+        anim->data = stored;  // Straight out of the mapping
+    }
+    anim->data_len = data_len;
+    return 0;
+}
+
+// Decode entry i of an index into slot
+static int load_record(const anim_file_t *anim, const unsigned char *index, uint32_t i, frame_slot_t *slot) {
+    uint32_t offset = get_u32(index + (size_t)i * 8 + 4);
+    if (offset >= anim->data_len) {
+        return -1;
+    }
+    slot->frame = (int)get_u32(index + (size_t)i * 8);
+    return decode_record(anim->data + offset, anim->data + anim->data_len, anim->rows, anim->cols, slot);
+}
+
+static void show_slot(frame_slot_t *slot, config_t *config, output_t *out, const struct timespec *epoch,
+                      int first_frame, int frame_rate) {
+    encode_frame(slot, config, NULL);
+    if (!config->offline) {
+        if (sleep_until_frame(epoch, slot->frame - first_frame, frame_rate)) {
+            stats_missed(config);
+        }
+    }
+    write_frame_timed(slot, config, out);
+}
+
+// Play a saved animation on out. Nothing is computed but the escape codes:
+// records come straight from the mapped file (or one decompressed copy).
+// Starts at config->start_frame, paced at the saved frame rate unless
+// --frame-rate overrides it, unpaced with --offline. Returns -1 if the
+// file cannot be read or is damaged.
+int play_animation(const char *path, config_t *config, output_t *out) {
+    int file = open(path, O_RDONLY);
+    if (file < 0) {
+        return -1;
+    }
+    struct stat st;
+    if (fstat(file, &st) != 0 || st.st_size <= 0) {
+        close(file);
+        errno = EINVAL;
+        return -1;
+    }
+    size_t size = (size_t)st.st_size;
+    void *map = mmap(NULL, size, PROT_READ, MAP_PRIVATE, file, 0);
+    close(file);
+    if (map == MAP_FAILED) {
+        return -1;
+    }
+
+    anim_file_t anim = {0};
+    char *inflated;
+    int status = parse_anim(&anim, map, size, &inflated);
+    int frame_rate = config->custom_frame_rate ? config->frame_rate : anim.frame_rate;
+    frame_slot_t slot = {0};
+    anim_screen_t screen = {0};
+    struct timespec epoch;
+    clock_gettime(CLOCK_MONOTONIC, &epoch);
+
+    uint32_t next = 0;
+    if (status == 0 && anim.frame_count > 0 && config->start_frame > (int)get_u32(anim.frames)) {
+        // Start from the last keyframe at or before the start frame, catch
+        // up on the changes after it and show the screen in one piece
+        uint32_t key = 0;
+        while (key + 1 < anim.keyframe_count &&
+               (int)get_u32(anim.keyframes + (size_t)(key + 1) * 8) <= config->start_frame) {
+            key++;
+        }
+        status = anim.keyframe_count ? init_screen(&screen, anim.rows, anim.cols) : -1;
+        if (status == 0) {
+            status = load_record(&anim, anim.keyframes, key, &slot);
+        }
+        int key_frame = slot.frame;
+        if (status == 0) {
+            apply_slot(&screen, &slot);
+        }
+        while (status == 0 && next < anim.frame_count &&
+               (int)get_u32(anim.frames + (size_t)next * 8) <= config->start_frame) {
+            if ((int)get_u32(anim.frames + (size_t)next * 8) > key_frame) {
+                status = load_record(&anim, anim.frames, next, &slot);
+                if (status == 0) {
+                    apply_slot(&screen, &slot);
+                }
+            }
+            next++;
+        }
+        if (status == 0) {
+            status = screen_to_slot(&screen, &slot, 0);
+            slot.frame = config->start_frame;
+        }
+        if (status == 0) {
+            show_slot(&slot, config, out, &epoch, config->start_frame, frame_rate);
+        }
+    }
+
+    int first_frame = config->start_frame;
+    if (status == 0 && next == 0 && anim.frame_count > 0) {
+        first_frame = (int)get_u32(anim.frames);
+    }
+    for (; status == 0 && next < anim.frame_count && !serve_hung_up(config); next++) {
+        status = load_record(&anim, anim.frames, next, &slot);
+        if (status == 0) {
+            show_slot(&slot, config, out, &epoch, first_frame, frame_rate);
+        }
+    }
+
+    free_frame_slot(&slot);
+    free_screen(&screen);
+    free(inflated);
+    munmap(map, size);
+    if (status != 0) {
+        errno = EINVAL;  // Not a saved animation, or damaged
+    }
+    return status;
+}
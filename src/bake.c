@@ -0,0 +1,160 @@
+#include "tte.h"
+
+// --bake: render the animation and write it out as a standalone C file.
+// The file holds the escape-code stream LZ-compressed (lz.c's format), a
+// table of where each frame ends and when it is due, and a player that
+// needs nothing beyond POSIX: inflate once, then write and sleep per
+// frame. Build it into a program and call tte_baked_play(fd), or compile
+// it alone with -DTTE_BAKED_MAIN for a self-contained player.
+
+typedef struct {
+    byte_buffer_t stream;     // Escape codes of every frame back to back
+    byte_buffer_t table;      // "{frame, end}," entries as C source
+    int first_frame;
+    int frame_count;
+} bake_t;
+
+static void bake_frame(void *ctx, int frame, const char *data, size_t len) {
+    bake_t *bake = ctx;
+    char entry[48];
+    if (bake->first_frame < 0) {
+        bake->first_frame = frame;
+    }
+    buffer_append(&bake->stream, data, len);
+    int n = snprintf(entry, sizeof(entry), "%s{%d, %lu},", bake->frame_count % 6 ? " " : "\n    ",
+                     frame - bake->first_frame, (unsigned long)bake->stream.len);
+    buffer_append(&bake->table, entry, n);
+    bake->frame_count++;
+}
+
+// The player written after the data. Kept in step with lz_decompress.
+static const char *bake_player =
+    "static int tte_inflate(unsigned char *dst, unsigned long dst_len) {\n"
+    "    const unsigned char *in = tte_data, *end = tte_data + sizeof(tte_data);\n"
+    "    unsigned long pos = 0;\n"
+    "    while (in < end) {\n"
+    "        unsigned token = *in++;\n"
+    "        unsigned long len = token >> 4, k;\n"
+    "        unsigned char b;\n"
+    "        if (len == 15) do { if (in >= end) return -1; b = *in++; len += b; } while (b == 255);\n"
+    "        if (len > (unsigned long)(end - in) || len > dst_len - pos) return -1;\n"
+    "        for (k = 0; k < len; k++) dst[pos++] = *in++;\n"
+    "        if (in == end) break;\n"
+    "        if (end - in < 2) return -1;\n"
+    "        unsigned long offset = in[0] | (in[1] << 8);\n"
+    "        in += 2;\n"
+    "        len = token & 15;\n"
+    "        if (len == 15) do { if (in >= end) return -1; b = *in++; len += b; } while (b == 255);\n"
+    "        len += 4;\n"
+    "        if (offset == 0 || offset > pos || len > dst_len - pos) return -1;\n"
+    "        for (k = 0; k < len; k++, pos++) dst[pos] = dst[pos - offset];\n"
+    "    }\n"
+    "    return pos == dst_len ? 0 : -1;\n"
+    "}\n"
+    "\n"
+    "static void tte_write(int fd, const unsigned char *data, unsigned long len) {\n"
+    "    while (len > 0) {\n"
+    "        ssize_t written = write(fd, data, len);\n"
+    "        if (written < 0) {\n"
+    "            if (errno == EINTR) continue;\n"
+    "            return;\n"
+    "        }\n"
+    "        data += written;\n"
+    "        len -= (unsigned long)written;\n"
+    "    }\n"
+    "}\n"
+    "\n"
+    "/* Play the animation on fd at its frame rate. Returns -1 if the data is\n"
+    "   damaged. */\n"
+    "int tte_baked_play(int fd) {\n"
+    "    static unsigned char stream[TTE_STREAM_LEN + 1];\n"
+    "    struct timespec epoch, deadline;\n"
+    "    unsigned long start = 0;\n"
+    "    unsigned i;\n"
+    "    if (tte_inflate(stream, TTE_STREAM_LEN) != 0) return -1;\n"
+    "    tte_write(fd, (const unsigned char *)TTE_PROLOGUE, sizeof(TTE_PROLOGUE) - 1);\n"
+    "    clock_gettime(CLOCK_MONOTONIC, &epoch);\n"
+    "    for (i = 0; i < sizeof(tte_frames) / sizeof(tte_frames[0]); i++) {\n"
+    "        long long offset = (long long)tte_frames[i][0] * 1000000000LL / TTE_FRAME_RATE;\n"
+    "        deadline = epoch;\n"
+    "        deadline.tv_sec += offset / 1000000000LL;\n"
+    "        deadline.tv_nsec += offset % 1000000000LL;\n"
+    "        if (deadline.tv_nsec >= 1000000000L) {\n"
+    "            deadline.tv_sec++;\n"
+    "            deadline.tv_nsec -= 1000000000L;\n"
+    "        }\n"
+    "        while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &deadline, NULL) == EINTR) {\n"
+    "        }\n"
+    "        tte_write(fd, stream + start, tte_frames[i][1] - start);\n"
+    "        start = tte_frames[i][1];\n"
+    "    }\n"
+    "    tte_write(fd, (const unsigned char *)TTE_EPILOGUE, sizeof(TTE_EPILOGUE) - 1);\n"
+    "    return 0;\n"
+    "}\n"
+    "\n"
+    "#ifdef TTE_BAKED_MAIN\n"
+    "int main(void) {\n"
+    "    return tte_baked_play(STDOUT_FILENO) == 0 ? 0 : 1;\n"
+    "}\n"
+    "#endif\n";
+
+// Write bytes as a C string literal
+static void write_c_string(FILE *file, const char *data, size_t len) {
+    fputc('"', file);
+    for (size_t i = 0; i < len; i++) {
+        fprintf(file, "\\x%02x", (unsigned char)data[i]);
+    }
+    fputc('"', file);
+}
+
+// Render the animation and write it to path as C source. Returns -1 on
+// failure.
+int bake_animation(terminal_t *term, config_t *config, effect_func_t func, worker_pool_t *pool,
+                   const char *path) {
+    bake_t bake = {{0}, {0}, -1, 0};
+    byte_buffer_t packed = {0};
+    int failed = render_offline(term, config, func, pool, config->start_frame, NULL, bake_frame, &bake) != 0;
+    failed |= bake.stream.len > UINT32_MAX;
+    if (!failed) {
+        failed = lz_compress(bake.stream.data, bake.stream.len, &packed) != 0;
+    }
+
+    FILE *file = failed ? NULL : fopen(path, "w");
+    if (file) {
+        fprintf(file, "/* %s animation baked by tte-c: %d frames, %lu bytes of escape codes.\n"
+                      "   Call tte_baked_play(fd), or build with -DTTE_BAKED_MAIN. */\n\n",
+                config->effect_name ? config->effect_name : "tte-c", bake.frame_count,
+                (unsigned long)bake.stream.len);
+        fputs("#define _POSIX_C_SOURCE 200809L\n"
+              "#include <errno.h>\n#include <time.h>\n#include <unistd.h>\n\n", file);
+        fprintf(file, "#define TTE_FRAME_RATE %d\n", config->frame_rate > 0 ? config->frame_rate : DEFAULT_FRAME_RATE);
+        fprintf(file, "#define TTE_STREAM_LEN %luUL\n", (unsigned long)bake.stream.len);
+        fputs("#define TTE_PROLOGUE ", file);
+        write_c_string(file, ANSI_HIDE_CURSOR, sizeof(ANSI_HIDE_CURSOR) - 1);
+        fputs("\n#define TTE_EPILOGUE ", file);
+        const char *epilogue = config->no_final_newline ? ANSI_SHOW_CURSOR : ANSI_SHOW_CURSOR "\n";
+        write_c_string(file, epilogue, strlen(epilogue));
+
+        // Frame deadlines are in frames since the first one
+        fputs("\n\nstatic const unsigned long tte_frames[][2] = {", file);
+        if (bake.frame_count == 0) {
+            fputs("\n    {0, 0},", file);
+        }
+        fwrite(bake.table.data, 1, bake.table.len, file);
+        fputs("\n};\n\nstatic const unsigned char tte_data[] = {", file);
+        for (size_t i = 0; i < packed.len; i++) {
+            fprintf(file, "%s0x%02x,", i % 16 ? " " : "\n    ", (unsigned char)packed.data[i]);
+        }
+        fputs("\n};\n\n", file);
+        fputs(bake_player, file);
+        failed = ferror(file);
+        failed |= fclose(file) != 0;
+    } else {
+        failed = 1;
+    }
+
+    buffer_free(&bake.stream);
+    buffer_free(&bake.table);
+    buffer_free(&packed);
+    return failed ? -1 : 0;
+}
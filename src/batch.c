@@ -0,0 +1,258 @@
+#include "tte.h"
+#ifdef __GLIBC__
+#include <malloc.h>
+#endif
+
+// --batch: render every job of a manifest headless, as fast as it renders,
+// spread over all cores. Each manifest line is
+//
+//     INPUT EFFECT OUTPUT [OPTION...]
+//
+// with blank lines and lines starting with '#' skipped. OUTPUT is written
+// like --record when it ends in .cast, like --bake when it ends in .c and
+// like --save otherwise. The options on the command line apply to every
+// job and a line's own options are applied on top. Each input file is read
+// once and shared, read-only, by every job that uses it.
+
+typedef struct {
+    char *path;
+    byte_buffer_t text;
+} batch_input_t;
+
+typedef struct {
+    int line;                 // In the manifest, for messages
+    config_t config;          // Command line options plus the line's own
+    const effect_info_t *effect;
+    int input;                // Index of its shared input
+    const char *output;
+    int status;               // 0 once rendered
+    double seconds;
+} batch_job_t;
+
+typedef struct {
+    batch_job_t *jobs;
+    int job_count;
+    batch_input_t *inputs;
+    int input_count;
+    int next;                 // Next job to hand out
+    int done;
+    int progress;             // Report each finished job on stderr
+} batch_t;
+
+static double seconds_since(const struct timespec *start) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (now.tv_sec - start->tv_sec) + (now.tv_nsec - start->tv_nsec) / 1e9;
+}
+
+static int has_suffix(const char *path, const char *suffix) {
+    size_t len = strlen(path), n = strlen(suffix);
+    return len > n && strcmp(path + len - n, suffix) == 0;
+}
+
+// Index of the shared copy of an input file, read the first time a job
+// names it; "-" is standard input. Returns -1 if it cannot be read.
+static int load_input(batch_t *batch, char *path) {
+    for (int i = 0; i < batch->input_count; i++) {
+        if (strcmp(batch->inputs[i].path, path) == 0) {
+            return i;
+        }
+    }
+    FILE *file = strcmp(path, "-") == 0 ? stdin : fopen(path, "r");
+    if (!file) {
+        return -1;
+    }
+    batch_input_t *inputs = realloc(batch->inputs, (batch->input_count + 1) * sizeof(batch_input_t));
+    if (!inputs) {
+        if (file != stdin) {
+            fclose(file);
+        }
+        return -1;
+    }
+    batch->inputs = inputs;
+    batch_input_t *input = &batch->inputs[batch->input_count++];
+    input->path = path;
+    memset(&input->text, 0, sizeof(input->text));
+    buffer_read_file(&input->text, file);
+    if (file != stdin) {
+        fclose(file);
+    }
+    return batch->input_count - 1;
+}
+
+// Split the manifest, in place, into jobs. Lines that cannot become a job
+// are reported and counted in *errors.
+static int parse_manifest(batch_t *batch, char *manifest, const config_t *base, int *errors) {
+    int line = 0;
+    for (char *next = manifest; next; ) {
+        char *text = next;
+        next = strchr(text, '\n');
+        if (next) {
+            *next++ = '\0';
+        }
+        line++;
+
+        char *argv[SERVE_MAX_ARGS];
+        int argc = 0;
+        argv[argc++] = "tte-c";
+        for (char *token = strtok(text, " \t\r"); token && argc < SERVE_MAX_ARGS; token = strtok(NULL, " \t\r")) {
+            argv[argc++] = token;
+        }
+        if (argc == 1 || argv[1][0] == '#') {
+            continue;
+        }
+        if (argc < 4) {
+            fprintf(stderr, "Manifest line %d: expected INPUT EFFECT OUTPUT [OPTION...]\n", line);
+            (*errors)++;
+            continue;
+        }
+
+        batch_job_t job = {0};
+        job.line = line;
+        job.config = *base;
+        job.config.batch_path = NULL;
+        // The line's own options; argv[3] stands in for the program name
+        if (parse_args(argc - 3, argv + 3, &job.config) != 0) {
+            fprintf(stderr, "Manifest line %d: invalid options\n", line);
+            (*errors)++;
+            continue;
+        }
+        job.config.effect_name = argv[2];
+        job.effect = find_effect(argv[2]);
+        if (!job.effect) {
+            fprintf(stderr, "Manifest line %d: unknown effect %s\n", line, argv[2]);
+            (*errors)++;
+            continue;
+        }
+        job.input = load_input(batch, argv[1]);
+        if (job.input < 0) {
+            fprintf(stderr, "Manifest line %d: cannot read %s: %s\n", line, argv[1], strerror(errno));
+            (*errors)++;
+            continue;
+        }
+        job.output = argv[3];
+        job.config.record_path = NULL;
+        job.config.save_path = NULL;
+        job.config.bake_path = NULL;
+        job.config.shm_name = NULL;
+        if (has_suffix(job.output, ".cast")) {
+            job.config.record_path = job.output;
+        } else if (has_suffix(job.output, ".c")) {
+            job.config.bake_path = job.output;
+        } else {
+            job.config.save_path = job.output;
+        }
+
+        batch_job_t *jobs = realloc(batch->jobs, (batch->job_count + 1) * sizeof(batch_job_t));
+        if (!jobs) {
+            return -1;
+        }
+        batch->jobs = jobs;
+        batch->jobs[batch->job_count++] = job;
+    }
+    return 0;
+}
+
+// Render one job on a terminal of its own
+static void run_job(batch_t *batch, batch_job_t *job) {
+    struct timespec start;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    terminal_t term = {0};
+    config_t *config = &job->config;
+    resolve_gradient(config);
+    if (layout_input(&term, config, &batch->inputs[job->input].text, config->record_width, config->record_height) != 0) {
+        fprintf(stderr, "Cannot render %s: out of memory\n", job->output);
+        job->status = 1;
+    } else {
+        job->status = render_headless(&term, config, job->effect, NULL);
+    }
+    cleanup_terminal(&term);
+    job->seconds = seconds_since(&start);
+
+    int done = __atomic_add_fetch(&batch->done, 1, __ATOMIC_RELAXED);
+    if (batch->progress) {
+        fprintf(stderr, "\r[%d/%d] %s\033[K", done, batch->job_count, job->output);
+    }
+}
+
+// Pool worker: take jobs until there are none left
+static void batch_worker(void *ctx, int worker) {
+    (void)worker;
+    batch_t *batch = ctx;
+    for (;;) {
+        int index = __atomic_fetch_add(&batch->next, 1, __ATOMIC_RELAXED);
+        if (index >= batch->job_count) {
+            return;
+        }
+        run_job(batch, &batch->jobs[index]);
+    }
+}
+
+// Run every job of the manifest at path on --threads workers, or one per
+// core. Returns nonzero if any line or job failed.
+int run_batch(config_t *config, const char *path) {
+    FILE *file = fopen(path, "r");
+    if (!file) {
+        fprintf(stderr, "Cannot read %s: %s\n", path, strerror(errno));
+        return 1;
+    }
+    byte_buffer_t manifest = {0};
+    buffer_read_file(&manifest, file);
+    fclose(file);
+    buffer_append(&manifest, "", 1);
+
+    batch_t batch = {0};
+    int errors = 0;
+    if (parse_manifest(&batch, manifest.data, config, &errors) != 0) {
+        fprintf(stderr, "Cannot read %s: out of memory\n", path);
+        errors++;
+    }
+
+#ifdef M_MMAP_THRESHOLD
+    // Every job's terminal is tens of megabytes of mostly untouched zeroes;
+    // keep them fresh mappings rather than worker arena memory that calloc
+    // has to clear (see serve)
+    mallopt(M_MMAP_THRESHOLD, 256 * 1024);
+#endif
+    int threads = config->threads > 1 ? config->threads : (int)sysconf(_SC_NPROCESSORS_ONLN);
+    if (threads > batch.job_count) {
+        threads = batch.job_count;
+    }
+    worker_pool_t *pool = worker_pool_create(threads);
+    batch.progress = isatty(STDERR_FILENO);
+
+    struct timespec start;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    if (pool) {
+        worker_pool_run(pool, batch_worker, &batch);
+    } else {
+        batch_worker(&batch, 0);
+    }
+    double elapsed = seconds_since(&start);
+    int workers = pool ? pool->count : 1;
+    worker_pool_destroy(pool);
+    if (batch.progress && batch.job_count) {
+        fprintf(stderr, "\r\033[K");
+    }
+
+    // Per-job timing, in manifest order
+    double busy = 0;
+    int failed = 0;
+    for (int i = 0; i < batch.job_count; i++) {
+        batch_job_t *job = &batch.jobs[i];
+        busy += job->seconds;
+        failed += job->status != 0;
+        fprintf(stderr, "%8.3f s  %-6s %-12s %s -> %s\n", job->seconds, job->status ? "FAILED" : "ok",
+                job->config.effect_name, batch.inputs[job->input].path, job->output);
+    }
+    fprintf(stderr, "%d jobs, %d failed, %d bad lines: %.3f s on %d workers (%.3f s of rendering)\n",
+            batch.job_count, failed, errors, elapsed, workers, busy);
+
+    for (int i = 0; i < batch.input_count; i++) {
+        buffer_free(&batch.inputs[i].text);
+    }
+    free(batch.inputs);
+    free(batch.jobs);
+    buffer_free(&manifest);
+    return failed || errors;
+}
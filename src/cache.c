@@ -0,0 +1,166 @@
+#include "tte.h"
+
+// Content-addressed cache of rendered animations (--cache). Entries are
+// saved animation files named after a hash of everything that decides the
+// frames: the input bytes, the effect, the layout, gradient and timing
+// options, the terminal size and the seed. Options applied at playback
+// (--no-color, --xterm-colors, --no-final-newline) are not part of the
+// key. Entries are written atomically and evicted least recently used
+// first, by modification time, which every hit refreshes.
+
+// 64-bit FNV-1a
+static uint64_t hash_bytes(uint64_t hash, const void *data, size_t len) {
+    const unsigned char *p = data;
+    for (size_t i = 0; i < len; i++) {
+        hash ^= p[i];
+        hash *= 1099511628211ULL;
+    }
+    return hash;
+}
+
+uint64_t cache_key(const terminal_t *term, const config_t *config, const char *input, size_t len) {
+    // Options are hashed as text so the key does not depend on struct layout
+    char fields[1024];
+    int n = snprintf(fields, sizeof(fields),
+                     "tte-c %d|%s|%dx%d|%dx%d|%d|%d|%d|%d|%d|%d|%d|%d|%.3f|%d|%d|%d|%d|%u|%d|",
+                     ANIM_VERSION, config->effect_name ? config->effect_name : "",
+                     term->terminal_width, term->terminal_height, term->canvas_width, term->canvas_height,
+                     config->anchor_canvas, config->anchor_text, config->ignore_terminal_dimensions,
+                     config->wrap_text, config->tab_width, config->use_gradient, config->gradient_direction,
+                     config->gradient_steps, config->gradient_angle, config->background_effect,
+                     config->background_intensity, term->easing ? (int)term->easing->easing : -1,
+                     config->frame_rate, config->seed, config->start_frame);
+    for (int i = 0; i < config->gradient_count && i < 8 && n > 0 && n < (int)sizeof(fields); i++) {
+        const rgb_color_t *stop = &config->gradient_stops[i];
+        n += snprintf(fields + n, sizeof(fields) - n, "%d,%d,%d|", stop->r, stop->g, stop->b);
+    }
+
+    uint64_t hash = 14695981039346656037ULL;
+    hash = hash_bytes(hash, fields, n > 0 && n < (int)sizeof(fields) ? (size_t)n : sizeof(fields) - 1);
+    return hash_bytes(hash, input, len);
+}
+
+// $XDG_CACHE_HOME/tte-c, or ~/.cache/tte-c, created if missing
+int cache_directory(char *dir, size_t size) {
+    const char *base = getenv("XDG_CACHE_HOME");
+    int n;
+    if (base && base[0] == '/') {
+        n = snprintf(dir, size, "%s", base);
+    } else {
+        const char *home = getenv("HOME");
+        if (!home || !home[0]) {
+            return -1;
+        }
+        n = snprintf(dir, size, "%s/.cache", home);
+    }
+    if (n < 0 || (size_t)n + sizeof("/tte-c") > size) {
+        return -1;
+    }
+    if (mkdir(dir, 0700) != 0 && errno != EEXIST) {
+        return -1;
+    }
+    strcat(dir, "/tte-c");
+    if (mkdir(dir, 0700) != 0 && errno != EEXIST) {
+        return -1;
+    }
+    return 0;
+}
+
+typedef struct {
+    char name[64];
+    off_t size;
+    time_t mtime;
+} cache_entry_t;
+
+static int older_first(const void *a, const void *b) {
+    const cache_entry_t *x = a;
+    const cache_entry_t *y = b;
+    return (x->mtime > y->mtime) - (x->mtime < y->mtime);
+}
+
+// Delete the least recently used entries until the cache fits in limit
+// bytes. Another process may be evicting too, so entries that vanish
+// underneath are simply skipped.
+void cache_evict(const char *dir, long long limit) {
+    DIR *handle = opendir(dir);
+    if (!handle) {
+        return;
+    }
+    cache_entry_t *entries = NULL;
+    size_t count = 0;
+    size_t capacity = 0;
+    long long total = 0;
+    char path[4096];
+
+    struct dirent *entry;
+    while ((entry = readdir(handle)) != NULL) {
+        size_t len = strlen(entry->d_name);
+        if (len < 5 || len >= sizeof(entries->name) || strcmp(entry->d_name + len - 4, ".tte") != 0) {
+            continue;
+        }
+        struct stat st;
+        snprintf(path, sizeof(path), "%s/%s", dir, entry->d_name);
+        if (stat(path, &st) != 0) {
+            continue;
+        }
+        if (count == capacity) {
+            size_t new_capacity = capacity ? capacity * 2 : 64;
+            cache_entry_t *grown = realloc(entries, new_capacity * sizeof(cache_entry_t));
+            if (!grown) {
+                break;
+            }
+            entries = grown;
+            capacity = new_capacity;
+        }
+        memcpy(entries[count].name, entry->d_name, len + 1);
+        entries[count].size = st.st_size;
+        entries[count].mtime = st.st_mtime;
+        total += st.st_size;
+        count++;
+    }
+    closedir(handle);
+
+    qsort(entries, count, sizeof(cache_entry_t), older_first);
+    for (size_t i = 0; i < count && total > limit; i++) {
+        snprintf(path, sizeof(path), "%s/%s", dir, entries[i].name);
+        if (unlink(path) == 0 || errno == ENOENT) {
+            total -= entries[i].size;
+        }
+    }
+    free(entries);
+}
+
+// Play the animation for term from the cache, rendering and storing it
+// first on a miss. Returns -1 if the cache cannot be used, in which case
+// the caller renders live.
+int cache_play(terminal_t *term, config_t *config, effect_func_t func, worker_pool_t *pool,
+               const char *input, size_t len, output_t *out) {
+    char dir[4096];
+    char path[4096 + 32];
+    if (cache_directory(dir, sizeof(dir)) != 0) {
+        return -1;
+    }
+    snprintf(path, sizeof(path), "%s/%016llx.tte", dir,
+             (unsigned long long)cache_key(term, config, input, len));
+
+    if (access(path, R_OK) == 0) {
+        utimensat(AT_FDCWD, path, NULL, 0);  // Now the most recently used
+    } else {
+        anim_writer_t writer;
+        if (anim_writer_init(&writer, term->terminal_height, term->terminal_width,
+                             config->frame_rate, 1) != 0 ||
+            render_offline(term, config, func, pool, config->start_frame,
+                           format_delta_frame, anim_writer_frame, &writer) != 0) {
+            writer.failed = 1;
+        }
+        if (anim_writer_finish(&writer, path) != 0) {
+            return -1;
+        }
+        cache_evict(dir, config->cache_limit);
+    }
+    if (play_animation(path, config, out) != 0) {
+        unlink(path);  // Damaged; the next run stores it again
+        return -1;
+    }
+    return 0;
+}
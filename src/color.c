@@ -245,97 +245,54 @@ void setup_gradient_colors(config_t *config, const char *effect_name) {
         
         // Random gradient direction for variety
         int directions[] = {GRADIENT_HORIZONTAL, GRADIENT_VERTICAL, GRADIENT_DIAGONAL, GRADIENT_RADIAL, GRADIENT_ANGLE};
-        config->gradient_direction = directions[rand() % 5];
+        config->gradient_direction = directions[random_range(config->seed, RANDOM_STREAM_GRADIENT, 0, 0, 5)];
         if (config->gradient_direction == GRADIENT_ANGLE) {
-            config->gradient_angle = (rand() % 360);  // Random angle
+            config->gradient_angle = random_range(config->seed, RANDOM_STREAM_GRADIENT, 1, 0, 360);  // Random angle
         }
     }
     
     config->gradient_steps = 64;  // High resolution for smooth gradients
 }
 
-void calculate_offsets(terminal_t *term, anchor_t canvas_anchor, anchor_t text_anchor) {
-    // Calculate canvas position in terminal
-    switch (canvas_anchor) {
-        case ANCHOR_SW:
-            term->canvas_offset_x = 0;
-            term->canvas_offset_y = term->terminal_height - term->canvas_height;
-            break;
-        case ANCHOR_S:
-            term->canvas_offset_x = (term->terminal_width - term->canvas_width) / 2;
-            term->canvas_offset_y = term->terminal_height - term->canvas_height;
-            break;
-        case ANCHOR_SE:
-            term->canvas_offset_x = term->terminal_width - term->canvas_width;
-            term->canvas_offset_y = term->terminal_height - term->canvas_height;
-            break;
-        case ANCHOR_E:
-            term->canvas_offset_x = term->terminal_width - term->canvas_width;
-            term->canvas_offset_y = (term->terminal_height - term->canvas_height) / 2;
-            break;
-        case ANCHOR_NE:
-            term->canvas_offset_x = term->terminal_width - term->canvas_width;
-            term->canvas_offset_y = 0;
-            break;
-        case ANCHOR_N:
-            term->canvas_offset_x = (term->terminal_width - term->canvas_width) / 2;
-            term->canvas_offset_y = 0;
-            break;
-        case ANCHOR_NW:
-            term->canvas_offset_x = 0;
-            term->canvas_offset_y = 0;
-            break;
-        case ANCHOR_W:
-            term->canvas_offset_x = 0;
-            term->canvas_offset_y = (term->terminal_height - term->canvas_height) / 2;
-            break;
+// Position of an inner_width x inner_height box anchored inside an outer one
+void anchor_offset(anchor_t anchor, int outer_width, int outer_height, int inner_width, int inner_height,
+                   int *x, int *y) {
+    int left = 0, center_x = (outer_width - inner_width) / 2, right = outer_width - inner_width;
+    int top = 0, center_y = (outer_height - inner_height) / 2, bottom = outer_height - inner_height;
+    switch (anchor) {
+        case ANCHOR_SW: *x = left;     *y = bottom;   break;
+        case ANCHOR_S:  *x = center_x; *y = bottom;   break;
+        case ANCHOR_SE: *x = right;    *y = bottom;   break;
+        case ANCHOR_E:  *x = right;    *y = center_y; break;
+        case ANCHOR_NE: *x = right;    *y = top;      break;
+        case ANCHOR_N:  *x = center_x; *y = top;      break;
+        case ANCHOR_NW: *x = left;     *y = top;      break;
+        case ANCHOR_W:  *x = left;     *y = center_y; break;
         case ANCHOR_C:
-        default:
-            term->canvas_offset_x = (term->terminal_width - term->canvas_width) / 2;
-            term->canvas_offset_y = (term->terminal_height - term->canvas_height) / 2;
-            break;
+        default:        *x = center_x; *y = center_y; break;
     }
-    
+}
+
+void calculate_offsets(terminal_t *term, anchor_t canvas_anchor, anchor_t text_anchor) {
+    // Calculate canvas position in terminal
+    anchor_offset(canvas_anchor, term->terminal_width, term->terminal_height,
+                  term->canvas_width, term->canvas_height, &term->canvas_offset_x, &term->canvas_offset_y);
+
     // Calculate text position within canvas
-    switch (text_anchor) {
-        case ANCHOR_SW:
-            term->text_offset_x = 0;
-            term->text_offset_y = term->canvas_height - term->text_height;
-            break;
-        case ANCHOR_S:
-            term->text_offset_x = (term->canvas_width - term->text_width) / 2;
-            term->text_offset_y = term->canvas_height - term->text_height;
-            break;
-        case ANCHOR_SE:
-            term->text_offset_x = term->canvas_width - term->text_width;
-            term->text_offset_y = term->canvas_height - term->text_height;
-            break;
-        case ANCHOR_E:
-            term->text_offset_x = term->canvas_width - term->text_width;
-            term->text_offset_y = (term->canvas_height - term->text_height) / 2;
-            break;
-        case ANCHOR_NE:
-            term->text_offset_x = term->canvas_width - term->text_width;
-            term->text_offset_y = 0;
-            break;
-        case ANCHOR_N:
-            term->text_offset_x = (term->canvas_width - term->text_width) / 2;
-            term->text_offset_y = 0;
-            break;
-        case ANCHOR_NW:
-            term->text_offset_x = 0;
-            term->text_offset_y = 0;
-            break;
-        case ANCHOR_W:
-            term->text_offset_x = 0;
-            term->text_offset_y = (term->canvas_height - term->text_height) / 2;
-            break;
-        case ANCHOR_C:
-        default:
-            term->text_offset_x = (term->canvas_width - term->text_width) / 2;
-            term->text_offset_y = (term->canvas_height - term->text_height) / 2;
-            break;
-    }
+    anchor_offset(text_anchor, term->canvas_width, term->canvas_height,
+                  term->text_width, term->text_height, &term->text_offset_x, &term->text_offset_y);
+}
+
+// Tile index (row-major, columns to a row) of a wall of tile_width x
+// tile_height tiles, anchored on a screen_width x screen_height output
+// that may be larger than its tile
+void tile_viewport(viewport_t *view, int index, int columns, int tile_width, int tile_height,
+                   int screen_width, int screen_height, anchor_t anchor) {
+    view->x = (index % columns) * tile_width;
+    view->y = (index / columns) * tile_height;
+    view->width = tile_width;
+    view->height = tile_height;
+    anchor_offset(anchor, screen_width, screen_height, tile_width, tile_height, &view->origin_x, &view->origin_y);
 }
 
 int get_gradient_color(int *gradient_colors, int gradient_count, float position) {
@@ -504,6 +461,25 @@ float apply_easing(float t, easing_t easing) {
     }
 }
 
+// Sample an easing curve once so hot loops avoid powf/sin/exp
+void build_easing_lut(easing_lut_t *lut, easing_t easing) {
+    lut->easing = easing;
+    for (int i = 0; i <= EASING_LUT_SIZE; i++) {
+        lut->samples[i] = apply_easing((float)i / EASING_LUT_SIZE, easing);
+    }
+}
+
+float easing_lookup(const easing_lut_t *lut, float t) {
+    // Clamp t to [0, 1]
+    if (t <= 0.0f) return 0.0f;
+    if (t >= 1.0f) return 1.0f;
+    if (lut->easing == EASE_LINEAR) return t;
+    
+    float x = t * EASING_LUT_SIZE;
+    int i = (int)x;
+    return lut->samples[i] + (lut->samples[i + 1] - lut->samples[i]) * (x - i);
+}
+
 float ease_in_quad(float t) {
     return t * t;
 }
@@ -559,11 +535,14 @@ float ease_out_bounce(float t) {
     if (t < 1.0f / d1) {
         return n1 * t * t;
     } else if (t < 2.0f / d1) {
-        return n1 * (t -= 1.5f / d1) * t + 0.75f;
+        t -= 1.5f / d1;
+        return n1 * t * t + 0.75f;
     } else if (t < 2.5f / d1) {
-        return n1 * (t -= 2.25f / d1) * t + 0.9375f;
+        t -= 2.25f / d1;
+        return n1 * t * t + 0.9375f;
     } else {
-        return n1 * (t -= 2.625f / d1) * t + 0.984375f;
+        t -= 2.625f / d1;
+        return n1 * t * t + 0.984375f;
     }
 }
 
@@ -748,7 +727,10 @@ void parse_gradient_colors(config_t *config, const char *colors_string) {
     
     char *colors_copy = malloc(strlen(colors_string) + 1);
     strcpy(colors_copy, colors_string);
-    char *token = strtok(colors_copy, ",");
+    // strtok_r: batch jobs, daemon clients and library contexts resolve
+    // their gradients on different threads at once
+    char *save = NULL;
+    char *token = strtok_r(colors_copy, ",", &save);
     
     while (token && config->gradient_count < 8) {
         rgb_color_t color = {255, 255, 255}; // Default white
@@ -779,7 +761,7 @@ void parse_gradient_colors(config_t *config, const char *colors_string) {
         config->gradient_stops[config->gradient_count] = color;
         config->gradient_count++;
         
-        token = strtok(NULL, ",");
+        token = strtok_r(NULL, ",", &save);
     }
     
     free(colors_copy);
@@ -790,9 +772,8 @@ void parse_gradient_colors(config_t *config, const char *colors_string) {
     }
 }
 
-void generate_auto_gradient(config_t *config, int seed) {
+void generate_auto_gradient(config_t *config, unsigned int seed) {
     // Generate a random gradient based on seed
-    srand(seed);
     
     // Choose a random preset
     gradient_preset_t presets[] = {
@@ -801,7 +782,7 @@ void generate_auto_gradient(config_t *config, int seed) {
         GRADIENT_PRESET_NEON, GRADIENT_PRESET_PASTEL
     };
     
-    int preset_index = rand() % 8;
+    int preset_index = random_range(seed, RANDOM_STREAM_GRADIENT, 2, 0, 8);
     setup_gradient_preset(config, presets[preset_index]);
     
     // Randomize direction
@@ -809,10 +790,10 @@ void generate_auto_gradient(config_t *config, int seed) {
         GRADIENT_HORIZONTAL, GRADIENT_VERTICAL, GRADIENT_DIAGONAL, 
         GRADIENT_RADIAL, GRADIENT_ANGLE
     };
-    config->gradient_direction = directions[rand() % 5];
+    config->gradient_direction = directions[random_range(seed, RANDOM_STREAM_GRADIENT, 0, 0, 5)];
     
     if (config->gradient_direction == GRADIENT_ANGLE) {
-        config->gradient_angle = rand() % 360;
+        config->gradient_angle = random_range(seed, RANDOM_STREAM_GRADIENT, 1, 0, 360);
     }
 }
 
@@ -1002,16 +983,25 @@ void render_plasma_background(terminal_t *term, config_t *config, int frame) {
     // Plasma-like background using mathematical functions
     float time = frame * 0.02f;
     
+    float x_step = 2.0f / (float)term->canvas_width;
+    
     for (int row = 0; row < term->canvas_height; row += 2) {
-        for (int col = 0; col < term->canvas_width; col += 2) {
+        float y = row / (float)term->canvas_height;
+        
+        // Terms linear in x rotate by a fixed angle per column step
+        float wave_y = fast_sinf(y * 8.0f + time * 1.5f);
+        phasor_t wave_x, wave_xy;
+        phasor_init(&wave_x, time, x_step * 10.0f);
+        phasor_init(&wave_xy, y * 12.0f + time * 2.0f, x_step * 12.0f);
+        
+        for (int col = 0; col < term->canvas_width; col += 2, phasor_next(&wave_x), phasor_next(&wave_xy)) {
             float x = col / (float)term->canvas_width;
-            float y = row / (float)term->canvas_height;
             
             // Complex plasma equation
-            float plasma = sin(x * 10.0f + time)
-                         + sin(y * 8.0f + time * 1.5f)
-                         + sin((x + y) * 12.0f + time * 2.0f)
-                         + sin(sqrt(x*x + y*y) * 15.0f + time * 0.8f);
+            float plasma = wave_x.s
+                         + wave_y
+                         + wave_xy.s
+                         + fast_sinf(fast_sqrtf(x*x + y*y) * 15.0f + time * 0.8f);
             
             plasma = (plasma + 4.0f) / 8.0f; // Normalize to 0-1
             
@@ -1042,7 +1032,7 @@ void render_background_to_screen(char screen[MAX_LINES][MAX_COLS],
         return;
     }
     
-    // Calculate screen area to render background
+    // Calculate screen area to render background (clean tiles are skipped)
     int start_row = term->canvas_offset_y;
     int start_col = term->canvas_offset_x;
     int end_row = start_row + term->canvas_height;
@@ -1060,7 +1050,7 @@ void render_background_to_screen(char screen[MAX_LINES][MAX_COLS],
                     int brightness_seed = (star * 7 + frame / 3) % 100;
                     if (brightness_seed < config->background_intensity && 
                         row >= 0 && row < MAX_LINES && col >= 0 && col < MAX_COLS) {
-                        if (screen[row][col] == ' ') { // Don't overwrite text
+                        if (tile_is_dirty(term, row, col) && screen[row][col] == ' ') { // Don't overwrite text
                             screen[row][col] = (brightness_seed < 20) ? '*' : '.';
                             screen_fg[row][col] = (brightness_seed < 30) ? 15 : 7;
                             screen_bold[row][col] = (brightness_seed < 10) ? 1 : 0;
@@ -1085,7 +1075,7 @@ void render_background_to_screen(char screen[MAX_LINES][MAX_COLS],
                         int char_row = fall_pos - trail;
                         if (char_row >= start_row && char_row < end_row && 
                             char_row >= 0 && char_row < MAX_LINES && col >= 0 && col < MAX_COLS) {
-                            if (screen[char_row][col] == ' ') {
+                            if (tile_is_dirty(term, char_row, col) && screen[char_row][col] == ' ') {
                                 screen[char_row][col] = matrix_chars[(col_seed + trail) % num_chars];
                                 screen_fg[char_row][col] = (trail == 0) ? 46 : (22 + trail * 4);
                                 screen_bold[char_row][col] = (trail < 2) ? 1 : 0;
@@ -1112,7 +1102,7 @@ void render_background_to_screen(char screen[MAX_LINES][MAX_COLS],
                     
                     if (row >= start_row && row < end_row && col >= start_col && col < end_col &&
                         row >= 0 && row < MAX_LINES && col >= 0 && col < MAX_COLS) {
-                        if (screen[row][col] == ' ') {
+                        if (tile_is_dirty(term, row, col) && screen[row][col] == ' ') {
                             screen[row][col] = particles[p % num_particles];
                             screen_fg[row][col] = 8 + (p % 8);
                             screen_bold[row][col] = 0;
@@ -1131,7 +1121,7 @@ void render_background_to_screen(char screen[MAX_LINES][MAX_COLS],
                 // Horizontal grid lines
                 for (int row = start_row; row < end_row; row += grid_spacing) {
                     for (int col = start_col; col < end_col && col < MAX_COLS; col++) {
-                        if (row >= 0 && row < MAX_LINES && screen[row][col] == ' ') {
+                        if (tile_is_dirty(term, row, col) && screen[row][col] == ' ') {
                             screen[row][col] = '-';
                             screen_fg[row][col] = pulse;
                             screen_bold[row][col] = 0;
@@ -1142,7 +1132,7 @@ void render_background_to_screen(char screen[MAX_LINES][MAX_COLS],
                 // Vertical grid lines
                 for (int col = start_col; col < end_col; col += grid_spacing) {
                     for (int row = start_row; row < end_row && row < MAX_LINES; row++) {
-                        if (col >= 0 && col < MAX_COLS && screen[row][col] == ' ') {
+                        if (tile_is_dirty(term, row, col) && screen[row][col] == ' ') {
                             screen[row][col] = '|';
                             screen_fg[row][col] = pulse;
                             screen_bold[row][col] = 0;
@@ -1164,7 +1154,7 @@ void render_background_to_screen(char screen[MAX_LINES][MAX_COLS],
                     int col2 = start_col + (int)((wave2 + 1.0f) * term->canvas_width * 0.5f);
                     
                     if (col1 >= start_col && col1 < end_col && col1 < MAX_COLS) {
-                        if (screen[row][col1] == ' ') {
+                        if (tile_is_dirty(term, row, col1) && screen[row][col1] == ' ') {
                             screen[row][col1] = '~';
                             screen_fg[row][col1] = 36; // Cyan
                             screen_bold[row][col1] = 0;
@@ -1172,7 +1162,7 @@ void render_background_to_screen(char screen[MAX_LINES][MAX_COLS],
                     }
                     
                     if (col2 >= start_col && col2 < end_col && col2 != col1 && col2 < MAX_COLS) {
-                        if (screen[row][col2] == ' ') {
+                        if (tile_is_dirty(term, row, col2) && screen[row][col2] == ' ') {
                             screen[row][col2] = '~';
                             screen_fg[row][col2] = 33; // Blue
                             screen_bold[row][col2] = 0;
@@ -1186,16 +1176,25 @@ void render_background_to_screen(char screen[MAX_LINES][MAX_COLS],
             {
                 float time = frame * 0.02f;
                 
+                float x_step = 2.0f / (float)term->canvas_width;
+                
                 for (int row = start_row; row < end_row; row += 2) {
-                    for (int col = start_col; col < end_col; col += 2) {
-                        if (row >= 0 && row < MAX_LINES && col >= 0 && col < MAX_COLS) {
+                    float y = (row - start_row) / (float)term->canvas_height;
+                    
+                    // Terms linear in x rotate by a fixed angle per column step
+                    float wave_y = fast_sinf(y * 8.0f + time * 1.5f);
+                    phasor_t wave_x, wave_xy;
+                    phasor_init(&wave_x, time, x_step * 10.0f);
+                    phasor_init(&wave_xy, y * 12.0f + time * 2.0f, x_step * 12.0f);
+                    
+                    for (int col = start_col; col < end_col; col += 2, phasor_next(&wave_x), phasor_next(&wave_xy)) {
+                        if (tile_is_dirty(term, row, col)) {
                             float x = (col - start_col) / (float)term->canvas_width;
-                            float y = (row - start_row) / (float)term->canvas_height;
                             
-                            float plasma = sin(x * 10.0f + time)
-                                         + sin(y * 8.0f + time * 1.5f)
-                                         + sin((x + y) * 12.0f + time * 2.0f)
-                                         + sin(sqrt(x*x + y*y) * 15.0f + time * 0.8f);
+                            float plasma = wave_x.s
+                                         + wave_y
+                                         + wave_xy.s
+                                         + fast_sinf(fast_sqrtf(x*x + y*y) * 15.0f + time * 0.8f);
                             
                             plasma = (plasma + 4.0f) / 8.0f;
                             
@@ -1217,3 +1216,21 @@ void render_background_to_screen(char screen[MAX_LINES][MAX_COLS],
             break;
     }
 }
+
+// Pick the gradient stops from the options: auto, preset, custom colors,
+// or the effect's own default
+void resolve_gradient(config_t *config) {
+    if (config->auto_gradient) {
+        // Generate random gradient
+        generate_auto_gradient(config, config->custom_seed ? config->seed : (unsigned int)time(NULL));
+    } else if (config->gradient_preset != GRADIENT_PRESET_CUSTOM) {
+        // Use specified preset
+        setup_gradient_preset(config, config->gradient_preset);
+    } else if (config->gradient_colors_string) {
+        // Parse custom colors
+        parse_gradient_colors(config, config->gradient_colors_string);
+    } else {
+        // Set up sophisticated gradients based on effect (default behavior)
+        setup_gradient_colors(config, config->effect_name);
+    }
+}
@@ -4,64 +4,35 @@ void effect_beams(terminal_t *term, int frame) {
     // Multiple beams sweep across canvas (rows and columns)
     int beam_width = 2;
     int beam_delay = 15; // Frames between beam groups
+    sweep_mask_t *mask = sweep_begin(term);
     
-    for (int i = 0; i < term->char_count; i++) {
-        character_t *ch = &term->chars[i];
-        ch->visible = 0; // Start hidden
-        ch->bold = 0;
-        
-        int illuminated = 0;
-        
-        // Row beams (horizontal sweeps)
-        for (int beam_group = 0; beam_group < 3; beam_group++) {
-            int beam_start = beam_group * beam_delay;
-            if (frame >= beam_start) {
-                int beam_pos = (frame - beam_start) * 2 - term->text_width;
-                if (beam_pos >= ch->target.col - beam_width && 
-                    beam_pos <= ch->target.col + beam_width) {
-                    // Character is in beam path for this row
-                    int row_match = (ch->target.row == beam_group * (term->text_height / 3));
-                    if (row_match || abs(ch->target.row - beam_group * (term->text_height / 3)) <= 1) {
-                        illuminated = 1;
-                        ch->bold = 1;
-                    }
-                }
-                // After beam passes, character remains visible
-                if (beam_pos > ch->target.col + beam_width) {
-                    int row_match = (ch->target.row == beam_group * (term->text_height / 3));
-                    if (row_match || abs(ch->target.row - beam_group * (term->text_height / 3)) <= 1) {
-                        ch->visible = 1;
-                    }
-                }
-            }
+    // Row beams (horizontal sweeps) light the rows around their band
+    for (int beam_group = 0; beam_group < 3; beam_group++) {
+        int beam_start = beam_group * beam_delay;
+        if (frame >= beam_start) {
+            int beam_pos = (frame - beam_start) * 2 - term->text_width;
+            int beam_row = beam_group * (term->text_height / 3);
+            sweep_band(mask, SWEEP_COLS, beam_pos, beam_width, beam_row - 1, beam_row + 1);
         }
-        
-        // Column beams (vertical sweeps) - start after horizontal
-        for (int beam_group = 0; beam_group < 2; beam_group++) {
-            int beam_start = 60 + beam_group * beam_delay; // Start after row beams
-            if (frame >= beam_start) {
-                int beam_pos = (frame - beam_start) * 1 - term->text_height;
-                if (beam_pos >= ch->target.row - beam_width && 
-                    beam_pos <= ch->target.row + beam_width) {
-                    // Character is in beam path for this column
-                    int col_match = (ch->target.col == beam_group * (term->text_width / 2) + term->text_width / 4);
-                    if (col_match || abs(ch->target.col - (beam_group * (term->text_width / 2) + term->text_width / 4)) <= 2) {
-                        illuminated = 1;
-                        ch->bold = 1;
-                    }
-                }
-                // After beam passes, character remains visible
-                if (beam_pos > ch->target.row + beam_width) {
-                    int col_match = (ch->target.col == beam_group * (term->text_width / 2) + term->text_width / 4);
-                    if (col_match || abs(ch->target.col - (beam_group * (term->text_width / 2) + term->text_width / 4)) <= 2) {
-                        ch->visible = 1;
-                    }
-                }
-            }
+    }
+    
+    // Column beams (vertical sweeps) - start after horizontal
+    for (int beam_group = 0; beam_group < 2; beam_group++) {
+        int beam_start = 60 + beam_group * beam_delay; // Start after row beams
+        if (frame >= beam_start) {
+            int beam_pos = (frame - beam_start) * 1 - term->text_height;
+            int beam_col = beam_group * (term->text_width / 2) + term->text_width / 4;
+            sweep_band(mask, SWEEP_ROWS, beam_pos, beam_width, beam_col - 2, beam_col + 2);
         }
+    }
+    
+    for (int i = 0; i < term->char_count; i++) {
+        character_t *ch = &term->chars[i];
         
-        if (illuminated) {
-            ch->visible = 1;
+        // Characters stay visible once a beam has reached them
+        ch->visible = sweep_revealed(mask, ch->target.row, ch->target.col);
+        ch->bold = sweep_highlighted(mask, ch->target.row, ch->target.col);
+        if (ch->bold) {
             ch->pos = ch->target;
         }
         
@@ -76,73 +47,134 @@ void effect_beams(terminal_t *term, int frame) {
 }
 
 // Simplified but effective versions of complex effects
-void effect_typewriter(terminal_t *term, int frame) {
+// Typewriter: characters appear in reading order, speed chars per frame
+static int typewriter_start(terminal_t *term, int i) {
     int speed = 2; // chars per frame
-    for (int i = 0; i < term->char_count; i++) {
-        character_t *ch = &term->chars[i];
-        int index = ch->target.row * term->text_width + ch->target.col;
-        if (index / speed <= frame) {
-            ch->visible = 1;
-            ch->pos = ch->target;
-            ch->bold = (frame - (index / speed)) < 3 ? 1 : 0; // brief bright
-            ch->active = 0;
-        }
-    }
+    character_t *ch = &term->chars[i];
+    return (ch->target.row * term->text_width + ch->target.col) / speed;
 }
 
-void effect_wipe(terminal_t *term, int frame) {
+static int typewriter_step(terminal_t *term, int i, int start_frame, int frame) {
+    character_t *ch = &term->chars[i];
+    ch->visible = 1;
+    ch->pos = ch->target;
+    ch->bold = (frame - start_frame) < 3 ? 1 : 0; // brief bright
+    ch->active = 0;
+    return ch->bold;
+}
+
+void effect_typewriter(terminal_t *term, int frame) {
+    run_reveal_timeline(term, frame, effect_typewriter, typewriter_start, typewriter_step);
+}
+
+// Wipe: a column edge sweeps right wipe_speed columns per frame
+static int wipe_start(terminal_t *term, int i) {
     int wipe_speed = 2;
-    int wipe_col = frame * wipe_speed;
-    for (int i = 0; i < term->char_count; i++) {
-        character_t *ch = &term->chars[i];
-        if (ch->target.col <= wipe_col) {
-            ch->visible = 1;
-            ch->pos = ch->target;
-            ch->bold = (ch->target.col == wipe_col) ? 1 : 0;
-            ch->active = 0;
+    return (term->chars[i].target.col + wipe_speed - 1) / wipe_speed;
+}
+
+static int wipe_step(terminal_t *term, int i, int start_frame, int frame) {
+    int wipe_speed = 2;
+    character_t *ch = &term->chars[i];
+    (void)start_frame;
+    ch->visible = 1;
+    ch->pos = ch->target;
+    ch->bold = (ch->target.col == frame * wipe_speed) ? 1 : 0;
+    ch->active = 0;
+    return ch->bold;
+}
+
+void effect_wipe(terminal_t *term, int frame) {
+    run_reveal_timeline(term, frame, effect_wipe, wipe_start, wipe_step);
+}
+
+// Spotlights: two spots wander across the text on closed-form paths
+#define SPOTLIGHT_RADIUS 6
+#define SPOTLIGHT_SETTLE 80
+
+static void spotlight_centers(terminal_t *term, int frame, int centers[2][2]) {
+    centers[0][0] = (frame) % term->text_height;
+    centers[0][1] = (frame * 2) % term->text_width;
+    centers[1][0] = (term->text_height - (frame) % term->text_height);
+    centers[1][1] = (term->text_width - (frame * 2) % term->text_width);
+}
+
+static int spotlight_covers(terminal_t *term, int row, int col, int frame) {
+    int centers[2][2];
+    spotlight_centers(term, frame, centers);
+    for (int s = 0; s < 2; s++) {
+        int dy = row - centers[s][0];
+        int dx = col - centers[s][1];
+        if (dx * dx + dy * dy <= SPOTLIGHT_RADIUS * SPOTLIGHT_RADIUS) {
+            return 1;
         }
     }
+    return 0;
 }
 
 void effect_spotlights(terminal_t *term, int frame) {
-    // Two moving spotlights brighten characters where they pass
-    int cx1 = (frame * 2) % term->text_width;
-    int cy1 = (frame) % term->text_height;
-    int cx2 = (term->text_width - (frame * 2) % term->text_width);
-    int cy2 = (term->text_height - (frame) % term->text_height);
-    int radius = 6;
+    // Two moving spotlights brighten characters where they pass. Until the
+    // text settles, everything a spot has passed over stays lit, so the
+    // earlier paths are stamped into the sweep mask
+    sweep_mask_t *mask = sweep_begin(term);
+    if (frame <= SPOTLIGHT_SETTLE) {
+        for (int f = 0; f < frame; f++) {
+            int centers[2][2];
+            spotlight_centers(term, f, centers);
+            sweep_disc(mask, centers[0][0], centers[0][1], SPOTLIGHT_RADIUS);
+            sweep_disc(mask, centers[1][0], centers[1][1], SPOTLIGHT_RADIUS);
+        }
+    }
+    
     for (int i = 0; i < term->char_count; i++) {
         character_t *ch = &term->chars[i];
-        int dx1 = ch->target.col - cx1;
-        int dy1 = ch->target.row - cy1;
-        int dx2 = ch->target.col - cx2;
-        int dy2 = ch->target.row - cy2;
-        int in1 = dx1*dx1 + dy1*dy1 <= radius*radius;
-        int in2 = dx2*dx2 + dy2*dy2 <= radius*radius;
-        if (in1 || in2) {
+        int row = ch->target.row;
+        int col = ch->target.col;
+        if (spotlight_covers(term, row, col, frame)) {
             ch->visible = 1;
             ch->pos = ch->target;
             ch->bold = 1;
-        } else if (frame > 80) {
+            // After settling, only a character lit on every frame since
+            // is still active
+            if (frame > SPOTLIGHT_SETTLE) {
+                int f = frame - 1;
+                while (f > SPOTLIGHT_SETTLE && spotlight_covers(term, row, col, f)) {
+                    f--;
+                }
+                ch->active = (f == SPOTLIGHT_SETTLE);
+            }
+        } else if (frame > SPOTLIGHT_SETTLE) {
             ch->visible = 1;
             ch->pos = ch->target;
             ch->bold = 0;
             ch->active = 0;
+        } else if (sweep_revealed(mask, row, col)) {
+            ch->visible = 1;
+            ch->pos = ch->target;
+            ch->bold = 1;
         }
     }
 }
 
+// Burn: rows ignite from the top and flicker briefly before settling
+static int burn_start(terminal_t *term, int i) {
+    return term->chars[i].target.row * 2;
+}
+
+static int burn_step(terminal_t *term, int i, int start_frame, int frame) {
+    int flicker_frames = 12;
+    character_t *ch = &term->chars[i];
+    int flickering = (frame - start_frame) < flicker_frames;
+    ch->visible = 1;
+    ch->pos = ch->target;
+    ch->bold = (flickering && random_range(term->seed, RANDOM_STREAM_BURN, i, frame, 5) == 0) ? 1 : 0; // flicker
+    ch->active = 0;
+    return flickering;
+}
+
 void effect_burn(terminal_t *term, int frame) {
     // Vertical burn reveal from top with flicker
-    for (int i = 0; i < term->char_count; i++) {
-        character_t *ch = &term->chars[i];
-        if (ch->target.row <= frame / 2) {
-            ch->visible = 1;
-            ch->pos = ch->target;
-            ch->bold = (rand() % 5 == 0) ? 1 : 0; // flicker
-            ch->active = 0;
-        }
-    }
+    run_reveal_timeline(term, frame, effect_burn, burn_start, burn_step);
 }
 
 void effect_swarm(terminal_t *term, int frame) {
@@ -150,7 +182,7 @@ void effect_swarm(terminal_t *term, int frame) {
     for (int i = 0; i < term->char_count; i++) {
         character_t *ch = &term->chars[i];
         // Simple pseudo-random initial positions based on index
-        int seed = (i * 1103515245 + 12345) & 0x7fffffff;
+        int seed = (int)(((unsigned int)(term->char_base + i) * 1103515245u + 12345u) & 0x7fffffff);
         int start_col = seed % (term->text_width * 2) - term->text_width;
         int start_row = (seed / 97) % (term->text_height * 2) - term->text_height;
         
@@ -173,8 +205,9 @@ void effect_waves(terminal_t *term, int frame) {
     for (int i = 0; i < term->char_count; i++) {
         character_t *ch = &term->chars[i];
         
-        // Calculate wave effect
-        float wave_offset = sin((ch->target.col * wave_frequency) + (frame * wave_speed * 0.1f)) * wave_amplitude;
+        // Calculate wave effect; one sine drives both offset and brightness
+        float wave = fast_sinf((ch->target.col * wave_frequency) + (frame * wave_speed * 0.1f));
+        float wave_offset = wave * wave_amplitude;
         
         ch->pos.row = ch->target.row + (int)wave_offset;
         ch->pos.col = ch->target.col;
@@ -184,7 +217,7 @@ void effect_waves(terminal_t *term, int frame) {
             ch->visible = 1;
             
             // Modify boldness based on wave position (keep gradient colors)
-            float wave_color = (sin((ch->target.col * wave_frequency) + (frame * wave_speed * 0.1f)) + 1.0f) / 2.0f;
+            float wave_color = (wave + 1.0f) / 2.0f;
             if (wave_color > 0.7f) {
                 ch->bold = 1;  // Bright wave peaks
             } else {
@@ -201,71 +234,80 @@ void effect_waves(terminal_t *term, int frame) {
     }
 }
 
-void effect_rain(terminal_t *term, int frame) {
+// Rain: characters drop from above the text with staggered timing
+static int rain_start(terminal_t *term, int i) {
+    return term->chars[i].target.col * 5 + (i % 20) * 3;
+}
+
+static int rain_step(terminal_t *term, int i, int start_frame, int frame) {
     int fall_speed = 1;
+    character_t *ch = &term->chars[i];
+    ch->visible = 1;
     
-    for (int i = 0; i < term->char_count; i++) {
-        character_t *ch = &term->chars[i];
-        
-        // Start characters at top of screen with staggered timing
-        int start_frame = ch->target.col * 5 + (i % 20) * 3;
-        
-        if (frame >= start_frame) {
-            ch->visible = 1;
-            
-            // Calculate falling position
-            int fall_distance = (frame - start_frame) * fall_speed;
-            ch->pos.row = -term->text_height + fall_distance;
-            ch->pos.col = ch->target.col;
-            
-            // Modify brightness as it falls (keep gradient colors)
-            float fall_progress = (float)(ch->pos.row + term->text_height) / (float)(ch->target.row + term->text_height);
-            if (fall_progress < 0.5f) {
-                ch->bold = 1;  // Bright while falling
-            } else {
-                ch->bold = 0;  // Normal gradient color
-            }
-            
-            // Stop at target position
-            if (ch->pos.row >= ch->target.row) {
-                ch->pos.row = ch->target.row;
-                ch->bold = 0;  // Keep gradient color
-                ch->active = 0;
-            }
-        }
+    // Calculate falling position
+    int fall_distance = (frame - start_frame) * fall_speed;
+    ch->pos.row = -term->text_height + fall_distance;
+    ch->pos.col = ch->target.col;
+    
+    // Modify brightness as it falls (keep gradient colors)
+    float fall_progress = (float)(ch->pos.row + term->text_height) / (float)(ch->target.row + term->text_height);
+    if (fall_progress < 0.5f) {
+        ch->bold = 1;  // Bright while falling
+    } else {
+        ch->bold = 0;  // Normal gradient color
+    }
+    
+    // Stop at target position
+    if (ch->pos.row >= ch->target.row) {
+        ch->pos.row = ch->target.row;
+        ch->bold = 0;  // Keep gradient color
+        ch->active = 0;
+        return 0;
     }
+    return 1;
+}
+
+void effect_rain(terminal_t *term, int frame) {
+    run_reveal_timeline(term, frame, effect_rain, rain_start, rain_step);
 }
 
 void effect_slide(terminal_t *term, int frame) {
     int slide_speed = 2;
+    lane_table_t *lanes = lanes_begin(term);
+    if (!lanes) {
+        return;
+    }
+    
+    // Each row slides in from off-screen left, starting at its own frame
+    for (int row = 0; row < lanes->height; row++) {
+        lane_state_t *lane = &lanes->rows[row];
+        lane->start = row * 5;
+        if (frame < lane->start) {
+            lane->phase = LANE_WAITING;
+            continue;
+        }
+        lane->phase = LANE_RUNNING;
+        lane->head = -term->text_width + (frame - lane->start) * slide_speed;
+    }
     
     for (int i = 0; i < term->char_count; i++) {
         character_t *ch = &term->chars[i];
+        lane_state_t *lane = &lanes->rows[ch->target.row];
+        if (lane->phase == LANE_WAITING) {
+            continue;
+        }
         
-        // Start characters off-screen to the left
-        int start_frame = ch->target.row * 5;
+        ch->visible = 1;
+        ch->pos.row = ch->target.row;
+        ch->pos.col = lane->head;
         
-        if (frame >= start_frame) {
-            ch->visible = 1;
-            
-            // Calculate sliding position
-            int slide_distance = (frame - start_frame) * slide_speed;
-            ch->pos.row = ch->target.row;
-            ch->pos.col = -term->text_width + slide_distance;
-            
-            // Brighten while sliding
-            if (ch->pos.col < ch->target.col) {
-                ch->bold = 1;
-            } else {
-                ch->bold = 0;
-            }
-            
-            // Stop at target position
-            if (ch->pos.col >= ch->target.col) {
-                ch->pos.col = ch->target.col;
-                ch->bold = 0;  // Keep gradient color
-                ch->active = 0;
-            }
+        // Brighten while sliding, stop at target position
+        if (lane->head < ch->target.col) {
+            ch->bold = 1;
+        } else {
+            ch->pos.col = ch->target.col;
+            ch->bold = 0;  // Keep gradient color
+            ch->active = 0;
         }
     }
 }
@@ -298,8 +340,9 @@ void effect_expand(terminal_t *term, int frame) {
                 ch->bold = 1;  // Bright while expanding
             }
             
-            ch->pos.row = center_row + (int)(dy * progress);
-            ch->pos.col = center_col + (int)(dx * progress);
+            float eased = ease_motion(term, progress);
+            ch->pos.row = center_row + (int)(dy * eased);
+            ch->pos.col = center_col + (int)(dx * eased);
         }
     }
 }
@@ -308,25 +351,42 @@ void effect_matrix(terminal_t *term, int frame) {
     // Matrix digital rain effect - columns of falling characters
     char matrix_chars[] = "0123456789ABCDEFGHIJKLMNOPQRSTUVWXYZ";
     int num_matrix_chars = sizeof(matrix_chars) - 1;
+    int trail_length = 8;
+    lane_table_t *lanes = lanes_begin(term);
+    if (!lanes) {
+        return;
+    }
+    
+    // Each column waits for its start frame, rains while the drop falls
+    // through it, and is done once the drop has cleared and lingered
+    for (int col = 0; col < lanes->width; col++) {
+        lane_state_t *lane = &lanes->cols[col];
+        lane->start = col * 12 + ((col * 7) % 20);
+        if (frame < lane->start) {
+            lane->phase = LANE_WAITING;
+            continue;
+        }
+        
+        // Calculate rain drop position - characters "fall" down the column
+        lane->head = (frame - lane->start) / 3 - term->text_height; // Slower falling
+        if (frame > lane->start + (term->text_height + trail_length) * 3 + 60) {
+            lane->phase = LANE_DONE;
+        } else {
+            lane->phase = LANE_RUNNING;
+        }
+    }
     
     for (int i = 0; i < term->char_count; i++) {
         character_t *ch = &term->chars[i];
+        lane_state_t *lane = &lanes->cols[ch->target.col];
         
-        // Each column starts at different times
-        int col_start_frame = ch->target.col * 12 + ((ch->target.col * 7) % 20);
-        
-        if (frame < col_start_frame) {
+        if (lane->phase == LANE_WAITING) {
             ch->visible = 0;
             continue;
         }
         
-        // Calculate rain drop position - characters "fall" down the column
-        int rain_progress = (frame - col_start_frame) / 3; // Slower falling
-        int drop_row = rain_progress - term->text_height;
-        
         // Create trailing effect - characters appear as the "rain" passes over them
-        int trail_length = 8;
-        int char_trail_pos = drop_row - ch->target.row;
+        int char_trail_pos = lane->head - ch->target.row;
         
         if (char_trail_pos >= -trail_length && char_trail_pos <= 2) {
             ch->visible = 1;
@@ -334,10 +394,15 @@ void effect_matrix(terminal_t *term, int frame) {
             
             // Change character to matrix symbols during rain
             if (char_trail_pos >= -2 && char_trail_pos <= 2) {
-                // Active rain area - cycle through matrix characters
-                if (frame % 4 == 0) {
+                // Active rain area - glyphs change every 4th frame, so show
+                // the one picked on the last such frame inside the area
+                int change_frame = frame - frame % 4;
+                int change_pos = (change_frame - lane->start) / 3 - term->text_height - ch->target.row;
+                if (change_frame >= lane->start && change_pos >= -2) {
                     int char_seed = (ch->target.col * 31 + ch->target.row * 17 + frame / 4) % num_matrix_chars;
                     ch->ch = matrix_chars[char_seed];
+                } else {
+                    ch->ch = ch->original_ch;
                 }
             }
             
@@ -360,15 +425,16 @@ void effect_matrix(terminal_t *term, int frame) {
                 ch->bold = 0;
             }
             
-        } else if (drop_row > ch->target.row + 2) {
+        } else if (char_trail_pos > 2) {
             // Rain has passed - show original character with gradient color
             ch->visible = 1;
             ch->pos = ch->target;
             ch->ch = ch->original_ch;  // Restore original character
-            ch->bold = 0;  // Use gradient color system
+            ch->color_fg = 15;  // Leading-edge white lingers until the final gradient
+            ch->bold = 0;
             
             // Mark as complete when all columns have finished raining
-            if (frame > col_start_frame + (term->text_height + trail_length) * 3 + 60) {
+            if (lane->phase == LANE_DONE) {
                 ch->active = 0;
             }
         }
@@ -435,8 +501,9 @@ void effect_fireworks(terminal_t *term, int frame) {
                 ch->visible = 1;
                 
                 // Move from explosion point to final position
-                ch->pos.col = shell_explode_col + (int)(dx * explode_progress);
-                ch->pos.row = shell_explode_row + (int)(dy * explode_progress);
+                float eased = ease_motion(term, explode_progress);
+                ch->pos.col = shell_explode_col + (int)(dx * eased);
+                ch->pos.row = shell_explode_row + (int)(dy * eased);
                 
                 // Color progression during explosion: white -> red -> orange -> yellow
                 if (explode_time < 8) {
@@ -455,10 +522,17 @@ void effect_fireworks(terminal_t *term, int frame) {
             }
             
         } else if (frame >= explode_frame + explosion_duration) {
-            // Settling phase - characters settle to final positions with gradient colors
+            // Settling phase - characters settle to final positions; the
+            // ones that exploded keep their last spark color until the final
+            // gradient
             ch->visible = 1;
             ch->pos = ch->target;
-            ch->bold = 0;  // Use gradient color system
+            ch->bold = 0;
+            int dx = ch->target.col - shell_explode_col;
+            int dy = ch->target.row - shell_explode_row;
+            if (sqrt(dx * dx + dy * dy) <= 8) {
+                ch->color_fg = 226;
+            }
             
             if (frame > explode_frame + explosion_duration + 30) {
                 ch->active = 0;
@@ -467,52 +541,59 @@ void effect_fireworks(terminal_t *term, int frame) {
     }
 }
 
-void effect_decrypt(terminal_t *term, int frame) {
-    // Movie-style decryption effect
-    for (int i = 0; i < term->char_count; i++) {
-        character_t *ch = &term->chars[i];
-        
-        // Each character gets decrypted at a different time
-        int decrypt_start = (ch->target.row * 15) + (ch->target.col * 3) + (i % 30);
-        int decrypt_duration = 60;
+// Decrypt: each character cycles through random glyphs before resolving
+static int decrypt_start(terminal_t *term, int i) {
+    character_t *ch = &term->chars[i];
+    return (ch->target.row * 15) + (ch->target.col * 3) + (i % 30);
+}
+
+static int decrypt_step(terminal_t *term, int i, int start_frame, int frame) {
+    int decrypt_duration = 60;
+    character_t *ch = &term->chars[i];
+    ch->visible = 1;
+    
+    int decrypt_progress = frame - start_frame;
+    
+    if (decrypt_progress < decrypt_duration) {
+        // Cycling through random characters during decrypt; glyphs change
+        // every 4th frame and hold in between
+        int change_frame = frame - frame % 4;
+        if (change_frame >= start_frame) {
+            char random_chars[] = "0123456789ABCDEF@#$%&*";
+            ch->ch = random_chars[random_range(term->seed, RANDOM_STREAM_DECRYPT, i, change_frame, sizeof(random_chars) - 1)];
+        } else {
+            ch->ch = ch->original_ch;
+        }
         
-        if (frame >= decrypt_start) {
-            ch->visible = 1;
-            
-            int decrypt_progress = frame - decrypt_start;
-            
-            if (decrypt_progress < decrypt_duration) {
-                // Cycling through random characters during decrypt
-                if (frame % 4 == 0) {
-                    // Change character periodically during decryption
-                    char random_chars[] = "0123456789ABCDEF@#$%&*";
-                    ch->ch = random_chars[rand() % (sizeof(random_chars) - 1)];
-                }
-                
-                // Color progression: red -> yellow -> green
-                float progress = (float)decrypt_progress / (float)decrypt_duration;
-                if (progress < 0.5f) {
-                    ch->color_fg = 196;  // Red
-                    ch->bold = 1;
-                } else if (progress < 0.8f) {
-                    ch->color_fg = 226;  // Yellow
-                    ch->bold = 1;
-                } else {
-                    ch->color_fg = 46;   // Green
-                    ch->bold = 0;
-                }
-                
-                ch->pos = ch->target;
-            } else {
-                // Decryption complete - show original character
-                ch->ch = ch->original_ch;  // Restore original character
-                // Keep gradient color (was set at initialization)
-                ch->bold = 0;
-                ch->pos = ch->target;
-                ch->active = 0;
-            }
+        // Color progression: red -> yellow -> green
+        float progress = (float)decrypt_progress / (float)decrypt_duration;
+        if (progress < 0.5f) {
+            ch->color_fg = 196;  // Red
+            ch->bold = 1;
+        } else if (progress < 0.8f) {
+            ch->color_fg = 226;  // Yellow
+            ch->bold = 1;
+        } else {
+            ch->color_fg = 46;   // Green
+            ch->bold = 0;
         }
+        
+        ch->pos = ch->target;
+        return 1;
     }
+    
+    // Decryption complete - show original character
+    ch->ch = ch->original_ch;  // Restore original character
+    ch->color_fg = 46;  // Stays green until the final gradient
+    ch->bold = 0;
+    ch->pos = ch->target;
+    ch->active = 0;
+    return 0;
+}
+
+void effect_decrypt(terminal_t *term, int frame) {
+    // Movie-style decryption effect
+    run_reveal_timeline(term, frame, effect_decrypt, decrypt_start, decrypt_step);
 }
 
 void effect_highlight(terminal_t *term, int frame) {
@@ -520,6 +601,15 @@ void effect_highlight(terminal_t *term, int frame) {
     int highlight_width = 8;
     float highlight_speed = 1.5f;
     
+    // Calculate diagonal highlight position (bottom-left to top-right)
+    float diagonal_pos = (frame * highlight_speed) - (term->text_width + term->text_height);
+    
+    // Intensity falls off linearly from the center; only the part above
+    // 0.3 intensity is bright
+    float bright_width = highlight_width * (1.0f - 0.3f);
+    sweep_mask_t *mask = sweep_begin(term);
+    sweep_band(mask, SWEEP_DIAG_DOWN, diagonal_pos, bright_width, 0, 0);
+    
     for (int i = 0; i < term->char_count; i++) {
         character_t *ch = &term->chars[i];
         
@@ -527,23 +617,8 @@ void effect_highlight(terminal_t *term, int frame) {
         ch->visible = 1;
         ch->pos = ch->target;
         
-        // Calculate diagonal highlight position (bottom-left to top-right)
-        float diagonal_pos = (frame * highlight_speed) - (term->text_width + term->text_height);
-        float char_diagonal = ch->target.col - ch->target.row; // Diagonal coordinate
-        
-        // Character is highlighted when diagonal sweep passes over it
-        if (diagonal_pos >= char_diagonal - highlight_width && 
-            diagonal_pos <= char_diagonal + highlight_width) {
-            // Calculate highlight intensity based on distance from center
-            float distance = fabs(diagonal_pos - char_diagonal);
-            float intensity = 1.0f - (distance / highlight_width);
-            
-            // Brighten character during highlight with intensity falloff
-            ch->bold = (intensity > 0.3f) ? 1 : 0;
-        } else {
-            // Normal gradient color when not highlighted
-            ch->bold = 0;
-        }
+        // Brighten characters under the highlight, normal gradient elsewhere
+        ch->bold = sweep_highlighted(mask, ch->target.row, ch->target.col);
         
         // Effect completes when highlight has passed all characters
         if (diagonal_pos > term->text_width + highlight_width) {
@@ -569,14 +644,16 @@ void effect_unstable(terminal_t *term, int frame) {
             float progress = (float)frame / (float)explosion_duration;
             
             // Calculate explosion direction for this character
-            int seed = i * 1103515245 + 12345;
+            unsigned int seed = (unsigned int)(term->char_base + i) * 1103515245u + 12345u;
             float angle = ((seed & 0xFFFF) / 65535.0f) * 2.0f * M_PI;
             
             // Explosion distance increases over time
             int explosion_radius = (int)(progress * (term->text_width + term->text_height));
             
-            ch->pos.row = center_row + (int)(sin(angle) * explosion_radius);
-            ch->pos.col = center_col + (int)(cos(angle) * explosion_radius);
+            float sin_a, cos_a;
+            fast_sincosf(angle, &sin_a, &cos_a);
+            ch->pos.row = center_row + (int)(sin_a * explosion_radius);
+            ch->pos.col = center_col + (int)(cos_a * explosion_radius);
             
             // Orange/red unstable color during explosion
             ch->color_fg = 208;  // Orange
@@ -587,34 +664,32 @@ void effect_unstable(terminal_t *term, int frame) {
             int reassembly_frame = frame - explosion_duration;
             float progress = (float)reassembly_frame / (float)reassembly_duration;
             
-            // Ease-out motion (exponential decay)
-            float ease_progress = 1.0f - powf(1.0f - progress, 3.0f);
+            // Eased motion (ease-out cubic unless --easing overrides)
+            float ease_progress = ease_motion(term, progress);
             
             // Calculate starting position from explosion
-            int seed = i * 1103515245 + 12345;
+            unsigned int seed = (unsigned int)(term->char_base + i) * 1103515245u + 12345u;
             float angle = ((seed & 0xFFFF) / 65535.0f) * 2.0f * M_PI;
             int explosion_radius = term->text_width + term->text_height;
             
-            int start_row = center_row + (int)(sin(angle) * explosion_radius);
-            int start_col = center_col + (int)(cos(angle) * explosion_radius);
+            float sin_a, cos_a;
+            fast_sincosf(angle, &sin_a, &cos_a);
+            int start_row = center_row + (int)(sin_a * explosion_radius);
+            int start_col = center_col + (int)(cos_a * explosion_radius);
             
             // Interpolate from explosion position to target
             ch->pos.row = start_row + (int)((ch->target.row - start_row) * ease_progress);
             ch->pos.col = start_col + (int)((ch->target.col - start_col) * ease_progress);
             
-            // Transition from unstable color to gradient
-            if (progress < 0.5f) {
-                ch->color_fg = 208;  // Orange
-                ch->bold = 1;
-            } else {
-                // Return to gradient color (will be set by gradient system)
-                ch->bold = 0;
-            }
+            // Orange stays until the final gradient; only bold fades
+            ch->color_fg = 208;
+            ch->bold = (progress < 0.5f) ? 1 : 0;
             
         } else {
             // Phase 3: Stable - characters at final positions
             ch->pos = ch->target;
-            ch->bold = 0;  // Normal gradient color
+            ch->color_fg = 208;
+            ch->bold = 0;
             ch->active = 0;
         }
     }
@@ -626,7 +701,7 @@ void effect_crumble(terminal_t *term, int frame) {
         character_t *ch = &term->chars[i];
         
         // Each character starts crumbling at different times based on position
-        int crumble_start = (ch->target.row * 10) + (ch->target.col * 3) + (i % 15);
+        int crumble_start = (ch->target.row * 10) + (ch->target.col * 3) + ((term->char_base + i) % 15);
         int crumble_duration = 80;
         
         if (frame < crumble_start) {
@@ -634,15 +709,18 @@ void effect_crumble(terminal_t *term, int frame) {
             ch->visible = 1;
             ch->pos = ch->target;
             ch->bold = 0;
-        } else if (frame < crumble_start + crumble_duration) {
-            // Character is crumbling - show falling motion
+        } else {
+            // Character is crumbling - show falling motion. Once it has
+            // crumbled it keeps where its last falling frame left it.
+            int last_frame = crumble_start + crumble_duration - 1;
+            int fall_frame = frame < last_frame ? frame : last_frame;
             ch->visible = 1;
             
-            int fall_time = frame - crumble_start;
+            int fall_time = fall_frame - crumble_start;
             float fall_progress = (float)fall_time / (float)crumble_duration;
             
             // Add some horizontal drift based on character index
-            int drift_seed = i * 1103515245 + 12345;
+            unsigned int drift_seed = (unsigned int)(term->char_base + i) * 1103515245u + 12345u;
             int drift_direction = (drift_seed & 1) ? 1 : -1;
             int horizontal_drift = (int)(fall_progress * 3.0f * drift_direction);
             
@@ -653,12 +731,13 @@ void effect_crumble(terminal_t *term, int frame) {
             ch->pos.col = ch->target.col + horizontal_drift;
             
             // Fade and flicker as it crumbles
-            ch->bold = (rand() % 4 == 0) ? 0 : 1;
+            ch->bold = (random_range(term->seed, RANDOM_STREAM_CRUMBLE, term->char_base + i, fall_frame, 4) == 0) ? 0 : 1;
             
-        } else {
-            // Character has finished crumbling - invisible
-            ch->visible = 0;
-            ch->active = 0;
+            if (frame > last_frame) {
+                // Character has finished crumbling - invisible
+                ch->visible = 0;
+                ch->active = 0;
+            }
         }
         
         // Final cleanup - show all characters in final positions after effect
@@ -675,79 +754,38 @@ void effect_slice(terminal_t *term, int frame) {
     // Text slicing from multiple directions - characters reveal as if cut by slicing motions
     int num_slices = 4;
     int slice_width = 3;
+    int diagonal_offset = (term->text_width + term->text_height) / 2;
+    sweep_mask_t *mask = sweep_begin(term);
     
-    for (int i = 0; i < term->char_count; i++) {
-        character_t *ch = &term->chars[i];
-        ch->visible = 0;
-        ch->bold = 0;
-        
-        int revealed = 0;
-        
-        // Multiple slicing motions from different angles
-        for (int slice_id = 0; slice_id < num_slices; slice_id++) {
-            int slice_start = slice_id * 20;
-            
-            if (frame >= slice_start) {
-                int slice_time = frame - slice_start;
-                
-                switch (slice_id) {
-                    case 0: // Horizontal slice from left
-                        if (slice_time * 2 >= ch->target.col - slice_width && 
-                            slice_time * 2 <= ch->target.col + slice_width) {
-                            revealed = 1;
-                            ch->bold = 1;
-                        }
-                        if (slice_time * 2 > ch->target.col + slice_width) {
-                            revealed = 1;
-                        }
-                        break;
-                        
-                    case 1: // Vertical slice from top
-                        if (slice_time >= ch->target.row - slice_width && 
-                            slice_time <= ch->target.row + slice_width) {
-                            revealed = 1;
-                            ch->bold = 1;
-                        }
-                        if (slice_time > ch->target.row + slice_width) {
-                            revealed = 1;
-                        }
-                        break;
-                        
-                    case 2: // Diagonal slice from top-left
-                        {
-                            int diagonal_pos = slice_time - (term->text_width + term->text_height) / 2;
-                            int char_diagonal = ch->target.col - ch->target.row;
-                            if (diagonal_pos >= char_diagonal - slice_width && 
-                                diagonal_pos <= char_diagonal + slice_width) {
-                                revealed = 1;
-                                ch->bold = 1;
-                            }
-                            if (diagonal_pos > char_diagonal + slice_width) {
-                                revealed = 1;
-                            }
-                        }
-                        break;
-                        
-                    case 3: // Diagonal slice from top-right
-                        {
-                            int diagonal_pos = slice_time - (term->text_width + term->text_height) / 2;
-                            int char_diagonal = ch->target.col + ch->target.row;
-                            if (diagonal_pos >= char_diagonal - slice_width && 
-                                diagonal_pos <= char_diagonal + slice_width) {
-                                revealed = 1;
-                                ch->bold = 1;
-                            }
-                            if (diagonal_pos > char_diagonal + slice_width) {
-                                revealed = 1;
-                            }
-                        }
-                        break;
-                }
-            }
+    // Multiple slicing motions from different angles
+    for (int slice_id = 0; slice_id < num_slices; slice_id++) {
+        int slice_start = slice_id * 20;
+        if (frame < slice_start) {
+            continue;
         }
+        int slice_time = frame - slice_start;
         
-        if (revealed) {
-            ch->visible = 1;
+        switch (slice_id) {
+            case 0: // Horizontal slice from left
+                sweep_band(mask, SWEEP_COLS, slice_time * 2, slice_width, 0, INT_MAX);
+                break;
+            case 1: // Vertical slice from top
+                sweep_band(mask, SWEEP_ROWS, slice_time, slice_width, 0, INT_MAX);
+                break;
+            case 2: // Diagonal slice from top-left
+                sweep_band(mask, SWEEP_DIAG_DOWN, slice_time - diagonal_offset, slice_width, 0, 0);
+                break;
+            case 3: // Diagonal slice from top-right
+                sweep_band(mask, SWEEP_DIAG_UP, slice_time - diagonal_offset, slice_width, 0, 0);
+                break;
+        }
+    }
+    
+    for (int i = 0; i < term->char_count; i++) {
+        character_t *ch = &term->chars[i];
+        ch->visible = sweep_revealed(mask, ch->target.row, ch->target.col);
+        ch->bold = sweep_highlighted(mask, ch->target.row, ch->target.col);
+        if (ch->visible) {
             ch->pos = ch->target;
         }
         
@@ -764,45 +802,64 @@ void effect_slice(terminal_t *term, int frame) {
 void effect_pour(terminal_t *term, int frame) {
     // Liquid pouring effect - characters flow like liquid from top to bottom
     int pour_speed = 2;
+    lane_table_t *lanes = lanes_begin(term);
+    if (!lanes) {
+        return;
+    }
+    
+    // Start pouring from different columns at different times; flow,
+    // spreading and wobble are shared by the whole column
+    for (int col = 0; col < lanes->width; col++) {
+        lane_state_t *lane = &lanes->cols[col];
+        lane->start = col * 8;
+        if (frame < lane->start) {
+            lane->phase = LANE_WAITING;
+            continue;
+        }
+        
+        // Calculate liquid flow position
+        int pour_time = frame - lane->start;
+        lane->head = (pour_time * pour_speed) - term->text_height;
+        
+        // Add some horizontal spreading like liquid
+        int spread_seed = (col * 31 + pour_time / 5) % 100;
+        int spread = (spread_seed < 20) ? -1 : (spread_seed > 80) ? 1 : 0;
+        
+        // Liquid-like wobbling motion
+        float wobble = fast_sinf((float)frame * 0.3f + col * 0.5f) * 0.5f;
+        lane->shift = spread + (int)wobble;
+        
+        // Eventually settle to final position
+        if (frame > lane->start + term->text_height * 2 + 40) {
+            lane->phase = LANE_DONE;
+        } else {
+            lane->phase = LANE_RUNNING;
+        }
+    }
     
     for (int i = 0; i < term->char_count; i++) {
         character_t *ch = &term->chars[i];
+        lane_state_t *lane = &lanes->cols[ch->target.col];
+        if (lane->phase == LANE_WAITING) {
+            continue;
+        }
         
-        // Start pouring from different columns at different times
-        int pour_start = ch->target.col * 8;
-        
-        if (frame >= pour_start) {
-            ch->visible = 1;
-            
-            // Calculate liquid flow position
-            int pour_time = frame - pour_start;
-            int flow_row = (pour_time * pour_speed) - term->text_height;
-            
-            // Add some horizontal spreading like liquid
-            int spread_seed = (ch->target.col * 31 + pour_time / 5) % 100;
-            int spread = (spread_seed < 20) ? -1 : (spread_seed > 80) ? 1 : 0;
-            
-            // Characters appear as the liquid "pours" past them
-            if (flow_row >= ch->target.row) {
-                ch->pos = ch->target;
-                ch->pos.col += spread;  // Add liquid spreading
-                
-                // Liquid-like wobbling motion
-                float wobble = sin((float)frame * 0.3f + ch->target.col * 0.5f) * 0.5f;
-                ch->pos.col += (int)wobble;
-                
-                // Bright while liquid is actively flowing
-                ch->bold = (flow_row - ch->target.row < 5) ? 1 : 0;
-            } else {
-                ch->visible = 0;
-            }
+        // Characters appear as the liquid "pours" past them
+        ch->visible = 1;
+        if (lane->head >= ch->target.row) {
+            ch->pos = ch->target;
+            ch->pos.col += lane->shift;
             
-            // Eventually settle to final position
-            if (frame > pour_start + term->text_height * 2 + 40) {
-                ch->pos = ch->target;
-                ch->bold = 0;
-                ch->active = 0;
-            }
+            // Bright while liquid is actively flowing
+            ch->bold = (lane->head - ch->target.row < 5) ? 1 : 0;
+        } else {
+            ch->visible = 0;
+        }
+        
+        if (lane->phase == LANE_DONE) {
+            ch->pos = ch->target;
+            ch->bold = 0;
+            ch->active = 0;
         }
     }
 }
@@ -812,8 +869,15 @@ void effect_blackhole(terminal_t *term, int frame) {
     int center_row = term->text_height / 2;
     int center_col = term->text_width / 2;
     int effect_duration = 100;
+    int return_duration = 60;
     
-    for (int i = 0; i < term->char_count; i++) {
+    // Orbit angles advance by a fixed step per character; the return phase
+    // starts from the angles of the last orbital frame
+    phasor_t orbit;
+    phasor_init(&orbit, (frame < effect_duration ? frame : effect_duration) * 0.1f, 0.3f);
+    phasor_seek(&orbit, term->char_base);
+    
+    for (int i = 0; i < term->char_count; i++, phasor_next(&orbit)) {
         character_t *ch = &term->chars[i];
         
         ch->visible = 1;
@@ -822,18 +886,17 @@ void effect_blackhole(terminal_t *term, int frame) {
             // Calculate gravitational pull toward center
             int dx = center_col - ch->target.col;
             int dy = center_row - ch->target.row;
-            float distance = sqrt(dx * dx + dy * dy);
+            float distance = fast_sqrtf(dx * dx + dy * dy);
             
             if (distance > 0) {
                 // Calculate orbital motion progress
                 float progress = (float)frame / (float)effect_duration;
                 
                 // Apply orbital motion
-                float angle_offset = frame * 0.1f + i * 0.3f;
                 float orbit_radius = distance * (1.0f - progress * 0.7f);
                 
-                ch->pos.col = center_col + (int)(cos(angle_offset) * orbit_radius);
-                ch->pos.row = center_row + (int)(sin(angle_offset) * orbit_radius);
+                ch->pos.col = center_col + (int)(orbit.c * orbit_radius);
+                ch->pos.row = center_row + (int)(orbit.s * orbit_radius);
                 
                 // Characters get brighter as they approach center
                 ch->bold = (distance < 8) ? 1 : 0;
@@ -844,23 +907,21 @@ void effect_blackhole(terminal_t *term, int frame) {
         } else {
             // Characters return to original positions
             int return_time = frame - effect_duration;
-            int return_duration = 60;
             
             if (return_time < return_duration) {
                 float return_progress = (float)return_time / (float)return_duration;
                 
-                // Ease-out motion back to original position
-                float ease_progress = 1.0f - powf(1.0f - return_progress, 3.0f);
+                // Eased motion back to original position
+                float ease_progress = ease_motion(term, return_progress);
                 
                 // Get current orbital position
                 int dx = center_col - ch->target.col;
                 int dy = center_row - ch->target.row;
-                float distance = sqrt(dx * dx + dy * dy);
-                float angle_offset = effect_duration * 0.1f + i * 0.3f;
+                float distance = fast_sqrtf(dx * dx + dy * dy);
                 float orbit_radius = distance * 0.3f;
                 
-                int orbit_col = center_col + (int)(cos(angle_offset) * orbit_radius);
-                int orbit_row = center_row + (int)(sin(angle_offset) * orbit_radius);
+                int orbit_col = center_col + (int)(orbit.c * orbit_radius);
+                int orbit_row = center_row + (int)(orbit.s * orbit_radius);
                 
                 ch->pos.col = orbit_col + (int)((ch->target.col - orbit_col) * ease_progress);
                 ch->pos.row = orbit_row + (int)((ch->target.row - orbit_row) * ease_progress);
@@ -882,40 +943,23 @@ void effect_rings(terminal_t *term, int frame) {
     int num_rings = 5;
     int ring_delay = 15;
     int ring_width = 3;
+    sweep_mask_t *mask = sweep_begin(term);
+    
+    // Characters are revealed when a ring passes over them, bright on its edge
+    for (int ring_id = 0; ring_id < num_rings; ring_id++) {
+        int ring_start = ring_id * ring_delay;
+        if (frame >= ring_start) {
+            int ring_time = frame - ring_start;
+            sweep_ring(mask, center_row, center_col, ring_time * 0.8f, ring_width);
+        }
+    }
     
     for (int i = 0; i < term->char_count; i++) {
         character_t *ch = &term->chars[i];
-        
-        ch->visible = 0;
-        ch->bold = 0;
-        
-        // Calculate distance from center
-        int dx = ch->target.col - center_col;
-        int dy = ch->target.row - center_row;
-        float distance = sqrt(dx * dx + dy * dy);
-        
-        // Check if character is revealed by any expanding ring
-        for (int ring_id = 0; ring_id < num_rings; ring_id++) {
-            int ring_start = ring_id * ring_delay;
-            
-            if (frame >= ring_start) {
-                int ring_time = frame - ring_start;
-                float ring_radius = ring_time * 0.8f;
-                
-                // Character is revealed when ring passes over it
-                if (ring_radius >= distance - ring_width && 
-                    ring_radius <= distance + ring_width) {
-                    ch->visible = 1;
-                    ch->pos = ch->target;
-                    ch->bold = 1;  // Bright ring edge
-                    break;
-                } else if (ring_radius > distance + ring_width) {
-                    // Ring has passed - character remains visible
-                    ch->visible = 1;
-                    ch->pos = ch->target;
-                    // Keep existing bold state from inner rings
-                }
-            }
+        ch->visible = sweep_revealed(mask, ch->target.row, ch->target.col);
+        ch->bold = sweep_highlighted(mask, ch->target.row, ch->target.col);
+        if (ch->visible) {
+            ch->pos = ch->target;
         }
         
         // Final cleanup
@@ -932,6 +976,34 @@ void effect_synthgrid(terminal_t *term, int frame) {
     // Synthwave grid backgrounds - retro-style grid with neon highlighting  
     int grid_spacing = 6;
     int scan_speed = 2;
+    int scan_cycle = term->text_height + 20;
+    int perspective_divisor = (term->text_height > 2) ? (term->text_height / 2) : 1;
+    lane_table_t *lanes = lanes_begin(term);
+    if (!lanes) {
+        return;
+    }
+    
+    // Plain text keeps the color of the last scan or perspective line that
+    // crossed its row. The scan line crosses every row once per cycle, so
+    // walking back one cycle finds it; the lane head holds that color
+    for (int row = 0; row < lanes->height; row++) {
+        lanes->rows[row].phase = LANE_WAITING;
+    }
+    for (int f = frame; f >= 0 && f > frame - scan_cycle; f--) {
+        int scan_line = (f * scan_speed) % scan_cycle;
+        int perspective_line = term->text_height - 1 - ((f / 3) % perspective_divisor);
+        for (int row = scan_line - 1; row <= scan_line + 1; row++) {
+            if (row >= 0 && row < lanes->height && lanes->rows[row].phase == LANE_WAITING) {
+                lanes->rows[row].phase = LANE_DONE;
+                lanes->rows[row].head = 51;
+            }
+        }
+        if (perspective_line >= 0 && perspective_line < lanes->height &&
+            lanes->rows[perspective_line].phase == LANE_WAITING) {
+            lanes->rows[perspective_line].phase = LANE_DONE;
+            lanes->rows[perspective_line].head = 201;
+        }
+    }
     
     for (int i = 0; i < term->char_count; i++) {
         character_t *ch = &term->chars[i];
@@ -944,12 +1016,11 @@ void effect_synthgrid(terminal_t *term, int frame) {
                           ((ch->target.col % grid_spacing) == 0);
         
         // Scanning line effect
-        int scan_line = (frame * scan_speed) % (term->text_height + 20);
+        int scan_line = (frame * scan_speed) % scan_cycle;
         int is_scan_line = (ch->target.row == scan_line) || 
                           (abs(ch->target.row - scan_line) == 1);
         
         // Perspective grid lines (getting closer at bottom)
-        int perspective_divisor = (term->text_height > 2) ? (term->text_height / 2) : 1;
         int perspective_line = term->text_height - 1 - 
                               ((frame / 3) % perspective_divisor);
         int is_perspective = (ch->target.row == perspective_line);
@@ -968,13 +1039,17 @@ void effect_synthgrid(terminal_t *term, int frame) {
             ch->color_fg = 25;   // Dark blue
             ch->bold = 0;
         } else {
-            // Regular text - use gradient colors (will be set by gradient system)
+            // Regular text - last line color to cross it, else its gradient
+            lane_state_t *lane = &lanes->rows[ch->target.row];
+            if (lane->phase == LANE_DONE) {
+                ch->color_fg = lane->head;
+            }
             ch->bold = 0;
         }
         
         // Add some flicker to grid lines for retro effect
         if (is_grid_line && frame % 8 == 0) {
-            ch->bold = (rand() % 10 < 3) ? 1 : 0;
+            ch->bold = (random_range(term->seed, RANDOM_STREAM_SYNTHGRID, term->char_base + i, frame, 10) < 3) ? 1 : 0;
         }
         
         // Effect completes after several scan cycles
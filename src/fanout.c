@@ -0,0 +1,418 @@
+#include "tte.h"
+
+// --output: one animation drawn on many terminals at once. Targets of the
+// same size share a terminal_t, so each frame is computed once per size,
+// and each size and color mode (a profile) encodes it once for all of its
+// targets. Writes never block: a target still taking an earlier frame
+// skips frames and is redrawn in full once it catches up, so one slow
+// terminal cannot hold back the others.
+//
+// With --wall the targets are instead tiles of one canvas the size of the
+// whole wall: it is computed once per frame, and each tile's viewport is
+// captured, encoded and written by its own pool worker.
+
+// Color mode a target asks for with a :mode suffix
+enum { COLOR_256, COLOR_XTERM, COLOR_NONE };
+
+// Everything drawn at one size
+typedef struct {
+    int width;
+    int height;
+    terminal_t term;
+    frame_slot_t delta;       // Cells changed this frame
+    frame_slot_t full;        // The whole screen, for targets that skipped frames
+    int changed;
+    int need_full;
+    int finished;
+} fanout_view_t;
+
+typedef struct {
+    fanout_view_t *view;
+    int color;
+    config_t config;          // Copy with this profile's color flags
+    byte_buffer_t delta;      // This frame, encoded
+    byte_buffer_t full;
+    int want_delta;
+    int want_full;
+} fanout_profile_t;
+
+typedef struct {
+    char path[PATH_MAX];
+    int fd;
+    output_t out;             // Nonblocking: queues what the terminal cannot take yet
+    int width;                // Terminal size
+    int height;
+    int color;
+    fanout_profile_t *profile;
+    viewport_t viewport;      // Wall: the tile it shows
+    frame_slot_t slot;        // Wall: this frame's runs of the tile
+    byte_buffer_t frame;      // Wall: and their encoding
+    int ready;                // Nothing queued; can take this frame
+    int stale;                // Skipped frames; the next one must redraw it all
+    unsigned long dropped;
+} fanout_target_t;
+
+typedef struct {
+    fanout_view_t views[MAX_OUTPUTS];
+    int view_count;
+    fanout_profile_t profiles[MAX_OUTPUTS];
+    int profile_count;
+    fanout_target_t targets[MAX_OUTPUTS];
+    int target_count;
+    int workers;              // Wall: pool workers sharing out the tiles
+    const config_t *config;   // For --stats
+} fanout_t;
+
+// Split "path[:mode]" into the path and its color mode; without a mode the
+// command line's color flags apply
+static int parse_target(const char *spec, const config_t *config, char *path, size_t size) {
+    int color = config->no_color ? COLOR_NONE : config->xterm_colors ? COLOR_XTERM : COLOR_256;
+    size_t len = strlen(spec);
+    const char *colon = strrchr(spec, ':');
+    if (colon && strcmp(colon + 1, "no-color") == 0) {
+        color = COLOR_NONE;
+        len = colon - spec;
+    } else if (colon && strcmp(colon + 1, "xterm-colors") == 0) {
+        color = COLOR_XTERM;
+        len = colon - spec;
+    }
+    snprintf(path, size, "%.*s", (int)len, spec);
+    return color;
+}
+
+// The profile for a size and color mode, laying out the text at that size
+// the first time it is seen. Returns NULL if the terminal cannot be allocated.
+static fanout_profile_t *find_profile(fanout_t *fan, config_t *config, const byte_buffer_t *input,
+                                      int width, int height, int color) {
+    for (int i = 0; i < fan->profile_count; i++) {
+        fanout_profile_t *profile = &fan->profiles[i];
+        if (profile->view->width == width && profile->view->height == height && profile->color == color) {
+            return profile;
+        }
+    }
+    fanout_view_t *view = NULL;
+    for (int i = 0; i < fan->view_count; i++) {
+        if (fan->views[i].width == width && fan->views[i].height == height) {
+            view = &fan->views[i];
+        }
+    }
+    if (!view) {
+        view = &fan->views[fan->view_count];
+        if (layout_input(&view->term, config, input, width, height) != 0) {
+            cleanup_terminal(&view->term);
+            memset(view, 0, sizeof(*view));
+            return NULL;
+        }
+        view->width = width;
+        view->height = height;
+        fan->view_count++;
+    }
+    fanout_profile_t *profile = &fan->profiles[fan->profile_count++];
+    profile->view = view;
+    profile->color = color;
+    profile->config = *config;
+    profile->config.no_color = color == COLOR_NONE;
+    profile->config.xterm_colors = color == COLOR_XTERM;
+    return profile;
+}
+
+// Wait until everything queued is written or the deadline passes
+static void target_drain(fanout_target_t *target, const struct timespec *deadline) {
+    while (!output_flush(&target->out) && !target->out.failed) {
+        struct timespec now;
+        clock_gettime(CLOCK_MONOTONIC, &now);
+        long long ms = (deadline->tv_sec - now.tv_sec) * 1000LL + (deadline->tv_nsec - now.tv_nsec) / 1000000;
+        struct pollfd pfd = {target->fd, POLLOUT, 0};
+        if (ms <= 0 || poll(&pfd, 1, (int)ms) == 0) {
+            return;  // Still stuck; give up on it
+        }
+    }
+}
+
+// Encode this frame once per profile that has a target ready for it: the
+// changed cells for targets that are up to date, the whole screen for
+// those that skipped frames. Then hand it to every ready target.
+static void send_frame(fanout_t *fan) {
+    for (int i = 0; i < fan->profile_count; i++) {
+        fan->profiles[i].want_delta = 0;
+        fan->profiles[i].want_full = 0;
+    }
+    for (int i = 0; i < fan->target_count; i++) {
+        fanout_target_t *target = &fan->targets[i];
+        if (!target->ready) {
+            continue;
+        }
+        if (target->stale) {
+            target->profile->want_full = 1;
+        } else if (target->profile->view->changed) {
+            target->profile->want_delta = 1;
+        }
+    }
+    for (int i = 0; i < fan->view_count; i++) {
+        fan->views[i].need_full = 0;
+    }
+    for (int i = 0; i < fan->profile_count; i++) {
+        fan->profiles[i].view->need_full |= fan->profiles[i].want_full;
+    }
+    for (int i = 0; i < fan->view_count; i++) {
+        if (fan->views[i].need_full) {
+            capture_screen(&fan->views[i].term, &fan->views[i].full);
+        }
+    }
+    for (int i = 0; i < fan->profile_count; i++) {
+        fanout_profile_t *profile = &fan->profiles[i];
+        profile->delta.len = 0;
+        profile->full.len = 0;
+        if (profile->want_delta) {
+            format_ansi_frame(&profile->view->delta, &profile->config, &profile->delta);
+        }
+        if (profile->want_full) {
+            format_ansi_frame(&profile->view->full, &profile->config, &profile->full);
+        }
+    }
+    double start = stats_start(fan->config);
+    size_t bytes = 0;
+    for (int i = 0; i < fan->target_count; i++) {
+        fanout_target_t *target = &fan->targets[i];
+        if (!target->ready) {
+            continue;
+        }
+        if (target->stale) {
+            output_write(&target->out, target->profile->full.data, target->profile->full.len);
+            bytes += target->profile->full.len;
+            target->stale = 0;
+        } else if (target->profile->view->changed) {
+            output_write(&target->out, target->profile->delta.data, target->profile->delta.len);
+            bytes += target->profile->delta.len;
+        }
+    }
+    if (bytes && fan->config->stats) {
+        // One sample per frame, over every target
+        stats_stop(fan->config, STAT_WRITE, start);
+        stats_add(fan->config->stats, STAT_BYTES, (double)bytes);
+    }
+}
+
+// Capture, encode and write the wall tiles of one worker: the dirty runs
+// of its viewport or, after skipped frames, all of it
+static void send_tiles(void *ctx, int worker) {
+    fanout_t *fan = ctx;
+    for (int i = worker; i < fan->target_count; i += fan->workers) {
+        fanout_target_t *target = &fan->targets[i];
+        if (!target->ready || (!target->stale && !target->profile->view->changed)) {
+            continue;
+        }
+        fanout_view_t *view = target->profile->view;
+        capture_viewport(&view->term, &target->slot, &target->viewport, target->stale);
+        target->stale = 0;
+        if (target->slot.run_count == 0) {
+            continue;  // Nothing changed on this tile
+        }
+        target->frame.len = 0;
+        format_ansi_frame(&target->slot, &target->profile->config, &target->frame);
+        double start = stats_start(fan->config);
+        output_write(&target->out, target->frame.data, target->frame.len);
+        if (fan->config->stats) {
+            // One sample per tile
+            stats_stop(fan->config, STAT_WRITE, start);
+            stats_add(fan->config->stats, STAT_BYTES, (double)target->frame.len);
+        }
+    }
+}
+
+// Hand this frame to every ready target
+static void send_targets(fanout_t *fan, config_t *config, worker_pool_t *pool) {
+    if (!config->wall_columns) {
+        send_frame(fan);
+    } else if (pool) {
+        worker_pool_run(pool, send_tiles, fan);
+    } else {
+        send_tiles(fan, 0);
+    }
+}
+
+// Lay the text out for the targets: each at its own size, or on a wall of
+// equal tiles as large as the smallest terminal. Returns -1 if it cannot.
+static int assign_profiles(fanout_t *fan, config_t *config, const byte_buffer_t *input) {
+    if (!config->wall_columns) {
+        for (int i = 0; i < fan->target_count; i++) {
+            fanout_target_t *target = &fan->targets[i];
+            target->profile = find_profile(fan, config, input, target->width, target->height, target->color);
+            if (!target->profile) {
+                fprintf(stderr, "Cannot draw on %s: out of memory\n", target->path);
+                return -1;
+            }
+        }
+        return 0;
+    }
+
+    int tiles = config->wall_columns * config->wall_rows;
+    if (fan->target_count != tiles) {
+        fprintf(stderr, "A %dx%d wall needs %d terminals, got %d\n", config->wall_columns,
+                config->wall_rows, tiles, fan->target_count);
+        return -1;
+    }
+    int tile_width = MAX_COLS / config->wall_columns;
+    int tile_height = MAX_LINES / config->wall_rows;
+    for (int i = 0; i < fan->target_count; i++) {
+        tile_width = fan->targets[i].width < tile_width ? fan->targets[i].width : tile_width;
+        tile_height = fan->targets[i].height < tile_height ? fan->targets[i].height : tile_height;
+    }
+    for (int i = 0; i < fan->target_count; i++) {
+        fanout_target_t *target = &fan->targets[i];
+        target->profile = find_profile(fan, config, input, tile_width * config->wall_columns,
+                                       tile_height * config->wall_rows, target->color);
+        if (!target->profile) {
+            fprintf(stderr, "Cannot draw the wall: out of memory\n");
+            return -1;
+        }
+        // A terminal larger than the tiles shows its tile where --anchor-canvas puts it
+        tile_viewport(&target->viewport, i, config->wall_columns, tile_width, tile_height,
+                      target->width, target->height, config->anchor_canvas);
+    }
+    return 0;
+}
+
+// Run the animation at its frame rate on every --output terminal. Returns
+// nonzero if a target could not be opened or stopped taking output.
+int fanout_animation(config_t *config, const effect_info_t *effect, const byte_buffer_t *input) {
+    fanout_t *fan = calloc(1, sizeof(fanout_t));
+    if (!fan) {
+        return 1;
+    }
+    resolve_gradient(config);
+    fan->config = config;
+    int status = 0;
+    for (int i = 0; i < config->output_count; i++) {
+        fanout_target_t *target = &fan->targets[fan->target_count];
+        target->color = parse_target(config->outputs[i], config, target->path, sizeof(target->path));
+        target->fd = open(target->path, O_WRONLY | O_NOCTTY | O_NONBLOCK);
+        if (target->fd < 0) {
+            fprintf(stderr, "Cannot open %s: %s\n", target->path, strerror(errno));
+            status = 1;
+            continue;
+        }
+        get_fd_size(target->fd, &target->width, &target->height);
+        output_init_nonblocking(&target->out, target->fd);
+        fan->target_count++;
+    }
+    int laid_out = assign_profiles(fan, config, input) == 0;
+    if (!laid_out) {
+        status = 1;  // Leave the terminals as they are
+    }
+    for (int i = 0; laid_out && i < fan->target_count; i++) {
+        output_write(&fan->targets[i].out, ANSI_HIDE_CURSOR, sizeof(ANSI_HIDE_CURSOR) - 1);
+    }
+
+    // Every wall tile gets a worker of its own
+    int threads = config->threads;
+    if (config->wall_columns && threads < fan->target_count) {
+        threads = fan->target_count;
+    }
+    worker_pool_t *pool = NULL;
+    if (threads > 1) {
+        pool = worker_pool_create(threads);
+    }
+    fan->workers = pool ? pool->count : 1;
+    int parallel = pool && (effect->flags & EFFECT_PARALLEL);
+    for (int i = 0; i < fan->view_count; i++) {
+        fan->views[i].term.pool = pool;
+    }
+    // A terminal that hangs up must not take the other targets with it
+    void (*sigpipe)(int) = signal(SIGPIPE, SIG_IGN);
+
+    struct timespec epoch;
+    clock_gettime(CLOCK_MONOTONIC, &epoch);
+    for (int frame = config->start_frame; laid_out && fan->view_count > 0; frame++) {
+        int running = 0;
+        for (int i = 0; i < fan->view_count; i++) {
+            fanout_view_t *view = &fan->views[i];
+            view->changed = 0;
+            if (view->finished) {
+                continue;
+            }
+            int active_chars = advance_effect(&view->term, config, effect->func, parallel ? pool : NULL, frame);
+            view->changed = composite_frame(&view->term, config);
+            if (view->changed && !config->wall_columns) {
+                capture_frame(&view->term, &view->delta);
+            }
+            view->finished = animation_finished(active_chars, frame);
+            running |= !view->finished;
+        }
+        // A target still taking an earlier frame misses any change in this one
+        for (int i = 0; i < fan->target_count; i++) {
+            fanout_target_t *target = &fan->targets[i];
+            target->ready = output_flush(&target->out);
+            if (!target->ready && !target->out.failed && target->profile->view->changed) {
+                target->dropped++;
+                target->stale = 1;
+            }
+        }
+        send_targets(fan, config, pool);
+        if (!running) {
+            break;
+        }
+        if (sleep_until_frame(&epoch, frame - config->start_frame + 1, config->frame_rate)) {
+            stats_missed(config);
+        }
+    }
+
+    // Targets that missed frames end on the final screen all the same;
+    // whatever is still pending goes first
+    for (int i = 0; i < fan->view_count; i++) {
+        fan->views[i].changed = 0;
+    }
+    for (int i = 0; i < fan->target_count; i++) {
+        fan->targets[i].ready = laid_out && !fan->targets[i].out.failed;
+    }
+    send_targets(fan, config, pool);
+    struct timespec deadline;
+    clock_gettime(CLOCK_MONOTONIC, &deadline);
+    deadline.tv_sec += OUTPUT_DRAIN_MS / 1000;
+    deadline.tv_nsec += (OUTPUT_DRAIN_MS % 1000) * 1000000L;
+    if (deadline.tv_nsec >= 1000000000L) {
+        deadline.tv_sec++;
+        deadline.tv_nsec -= 1000000000L;
+    }
+    for (int i = 0; laid_out && i < fan->target_count; i++) {
+        fanout_target_t *target = &fan->targets[i];
+        output_write(&target->out, ANSI_SHOW_CURSOR, sizeof(ANSI_SHOW_CURSOR) - 1);
+        if (!config->no_final_newline) {
+            output_write(&target->out, "\n", 1);
+        }
+    }
+    for (int i = 0; i < fan->target_count; i++) {
+        fanout_target_t *target = &fan->targets[i];
+        target_drain(target, &deadline);
+        size_t unwritten = output_pending(&target->out);
+        if (output_close(&target->out) != 0) {
+            fprintf(stderr, "Error writing %s\n", target->path);
+            status = 1;
+        } else if (unwritten) {
+            fprintf(stderr, "Gave up on %s with %zu bytes unwritten\n", target->path, unwritten);
+            status = 1;
+        }
+        if (target->dropped) {
+            fprintf(stderr, "%s: dropped %lu frames\n", target->path, target->dropped);
+        }
+        close(target->fd);
+        free_frame_slot(&target->slot);
+        buffer_free(&target->frame);
+    }
+    signal(SIGPIPE, sigpipe);
+
+    for (int i = 0; i < fan->profile_count; i++) {
+        buffer_free(&fan->profiles[i].delta);
+        buffer_free(&fan->profiles[i].full);
+    }
+    for (int i = 0; i < fan->view_count; i++) {
+        fanout_view_t *view = &fan->views[i];
+        view->term.pool = NULL;
+        free_frame_slot(&view->delta);
+        free_frame_slot(&view->full);
+        cleanup_terminal(&view->term);
+    }
+    worker_pool_destroy(pool);
+    free(fan);
+    return status;
+}
@@ -0,0 +1,78 @@
+#include "tte.h"
+
+// Cody-Waite split of pi/2 so range reduction keeps float precision
+#define FAST_PIO2_HI 1.57079637050628662109375f
+#define FAST_PIO2_LO -4.37113900018624283e-8f
+#define FAST_TWO_OVER_PI 0.636619772367581343f
+
+// Sine and cosine from one range reduction to [-pi/4, pi/4] and short
+// Taylor polynomials; absolute error stays below 1e-6, far under what a
+// terminal cell or 256-color quantization can show
+void fast_sincosf(float x, float *s, float *c) {
+    if (!(fabsf(x) < 1.0e6f)) {
+        // Huge or NaN arguments are never hot; defer to libm
+        *s = sinf(x);
+        *c = cosf(x);
+        return;
+    }
+
+    float kf = floorf(x * FAST_TWO_OVER_PI + 0.5f);
+    int quadrant = (int)kf & 3;
+    float r = (x - kf * FAST_PIO2_HI) - kf * FAST_PIO2_LO;
+    float r2 = r * r;
+
+    float sin_r = r + r * r2 * (-1.0f / 6.0f + r2 * (1.0f / 120.0f + r2 * (-1.0f / 5040.0f)));
+    float cos_r = 1.0f + r2 * (-0.5f + r2 * (1.0f / 24.0f + r2 * (-1.0f / 720.0f + r2 * (1.0f / 40320.0f))));
+
+    switch (quadrant) {
+        case 0: *s = sin_r;  *c = cos_r;  break;
+        case 1: *s = cos_r;  *c = -sin_r; break;
+        case 2: *s = -sin_r; *c = -cos_r; break;
+        default: *s = -cos_r; *c = sin_r; break;
+    }
+}
+
+float fast_sinf(float x) {
+    float s, c;
+    fast_sincosf(x, &s, &c);
+    return s;
+}
+
+float fast_cosf(float x) {
+    float s, c;
+    fast_sincosf(x, &s, &c);
+    return c;
+}
+
+// Single-precision square root; compiles to one instruction instead of a
+// double-precision libm call and conversions
+float fast_sqrtf(float x) {
+    return sqrtf(x);
+}
+
+// Walk sin/cos of start + n * step by rotating with a fixed step phasor
+void phasor_init(phasor_t *p, float start, float step) {
+    p->start = start;
+    p->step = step;
+    p->n = 0;
+    fast_sincosf(start, &p->s, &p->c);
+    fast_sincosf(step, &p->step_s, &p->step_c);
+}
+
+// Jump to step n; values then match a phasor that walked there
+void phasor_seek(phasor_t *p, int n) {
+    p->n = n;
+    fast_sincosf(p->start + n * p->step, &p->s, &p->c);
+}
+
+void phasor_next(phasor_t *p) {
+    p->n++;
+    if (p->n % PHASOR_RESYNC == 0) {
+        fast_sincosf(p->start + p->n * p->step, &p->s, &p->c);
+        return;
+    }
+    float s = p->s * p->step_c + p->c * p->step_s;
+    float c = p->c * p->step_c - p->s * p->step_s;
+    p->s = s;
+    p->c = c;
+}
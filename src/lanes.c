@@ -0,0 +1,51 @@
+#include "tte.h"
+
+void free_lane_table(terminal_t *term) {
+    lane_table_t *lanes = term->lanes;
+    if (lanes) {
+        free(lanes->cols);
+        free(lanes->rows);
+        free(lanes);
+        term->lanes = NULL;
+    }
+}
+
+// One lane per column and per row that holds a character
+static lane_table_t *build_lane_table(terminal_t *term) {
+    free_lane_table(term);
+
+    int width = term->text_width > 0 ? term->text_width : 1;
+    int height = term->text_height > 0 ? term->text_height : 1;
+    for (int i = 0; i < term->char_count; i++) {
+        if (term->chars[i].target.col >= width) width = term->chars[i].target.col + 1;
+        if (term->chars[i].target.row >= height) height = term->chars[i].target.row + 1;
+    }
+
+    lane_table_t *lanes = calloc(1, sizeof(lane_table_t));
+    if (!lanes) {
+        return NULL;
+    }
+    lanes->cols = calloc(width, sizeof(lane_state_t));
+    lanes->rows = calloc(height, sizeof(lane_state_t));
+    lanes->width = width;
+    lanes->height = height;
+    lanes->char_count = term->char_count;
+    lanes->text_width = term->text_width;
+    lanes->text_height = term->text_height;
+    term->lanes = lanes;
+    if (!lanes->cols || !lanes->rows) {
+        free_lane_table(term);
+        return NULL;
+    }
+    return lanes;
+}
+
+// Lane table sized for the current text; effects fill it every frame
+lane_table_t *lanes_begin(terminal_t *term) {
+    lane_table_t *lanes = term->lanes;
+    if (!lanes || lanes->char_count != term->char_count ||
+        lanes->text_width != term->text_width || lanes->text_height != term->text_height) {
+        lanes = build_lane_table(term);
+    }
+    return lanes;
+}
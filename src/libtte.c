@@ -0,0 +1,258 @@
+#include "tte.h"
+#include "libtte.h"
+
+// Everything one animation needs; nothing lives outside the context
+struct tte_ctx {
+    config_t config;
+    char effect_name[64];
+    const effect_info_t *effect;
+    int width;
+    int height;
+    terminal_t term;
+    worker_pool_t *pool;
+    frame_slot_t slot;
+    byte_buffer_t out;        // Encoded frame waiting to be copied out
+    int frame;                // Next frame to step
+    int loaded;
+    int finished;
+    int pending;              // out holds a frame the caller has not taken
+    int changed;              // The pending frame drew something
+    int settled;              // Nothing will change before the animation ends
+    int started;              // epoch is set
+    struct timespec epoch;    // When tte_tick showed the first frame
+    char **options;           // Copies of tte_set_options strings, which config points into
+    int option_count;
+};
+
+tte_ctx *tte_create(const char *effect, int width, int height) {
+    const effect_info_t *info = effect ? find_effect(effect) : NULL;
+    if (!info || strlen(effect) >= sizeof(((tte_ctx *)0)->effect_name) || width <= 0 || height <= 0) {
+        return NULL;
+    }
+    tte_ctx *ctx = calloc(1, sizeof(tte_ctx));
+    if (!ctx) {
+        return NULL;
+    }
+    init_config(&ctx->config);
+    strcpy(ctx->effect_name, effect);
+    ctx->config.effect_name = ctx->effect_name;
+    ctx->effect = info;
+    ctx->width = width < MAX_COLS ? width : MAX_COLS;
+    ctx->height = height < MAX_LINES ? height : MAX_LINES;
+    return ctx;
+}
+
+int tte_set_options(tte_ctx *ctx, int argc, const char *const argv[]) {
+    if (!ctx || ctx->loaded) {
+        return TTE_ERROR;
+    }
+    size_t size = 1;
+    for (int i = 0; i < argc; i++) {
+        // --help would print usage and exit the host
+        if (strcmp(argv[i], "-h") == 0 || strcmp(argv[i], "--help") == 0) {
+            return TTE_ERROR;
+        }
+        size += strlen(argv[i]) + 1;
+    }
+
+    // The config keeps pointers to some option values (--gradient-colors),
+    // so parse the context's own copies, kept until it is destroyed
+    char **options = realloc(ctx->options, (ctx->option_count + 1) * sizeof(char *));
+    if (options) {
+        ctx->options = options;
+    }
+    char *copy = malloc(size);
+    if (!options || !copy) {
+        free(copy);
+        return TTE_ERROR;
+    }
+    // parse_args skips argv[0] and never writes through argv
+    char *args[argc + 1];
+    args[0] = "libtte";
+    char *at = copy;
+    for (int i = 0; i < argc; i++) {
+        size_t len = strlen(argv[i]) + 1;
+        memcpy(at, argv[i], len);
+        args[i + 1] = at;
+        at += len;
+    }
+
+    // All or nothing: a bad option leaves the earlier ones unapplied
+    config_t config = ctx->config;
+    if (parse_args(argc + 1, args, &config) != 0) {
+        free(copy);
+        return TTE_ERROR;
+    }
+    config.effect_name = ctx->effect_name;  // The effect is fixed at creation
+    ctx->config = config;
+    ctx->options[ctx->option_count++] = copy;
+    return TTE_OK;
+}
+
+int tte_load_text(tte_ctx *ctx, const char *text, size_t len) {
+    if (!ctx) {
+        return TTE_ERROR;
+    }
+    cleanup_terminal(&ctx->term);  // Text loaded before, if any
+    memset(&ctx->term, 0, sizeof(ctx->term));
+    ctx->loaded = 0;
+    ctx->finished = 0;
+    ctx->pending = 0;
+    ctx->started = 0;  // tte_tick starts the clock again
+    ctx->frame = ctx->config.start_frame;
+
+    resolve_gradient(&ctx->config);
+    init_terminal(&ctx->term);
+    if (!ctx->term.chars || !ctx->term.fb || !ctx->term.damage) {
+        return TTE_ERROR;
+    }
+    ctx->term.seed = ctx->config.seed;
+    ctx->term.terminal_width = ctx->width;
+    ctx->term.terminal_height = ctx->height;
+    ctx->term.canvas_width = ctx->width;
+    ctx->term.canvas_height = ctx->height;
+    set_terminal_easing(&ctx->term, ctx->config.custom_easing ? ctx->config.easing
+                                                               : get_effect_easing(ctx->effect_name));
+    FILE *input = len ? fmemopen((void *)text, len, "r") : NULL;
+    if (input) {
+        read_input_text_from(&ctx->term, &ctx->config, input);
+        fclose(input);
+    } else if (len) {
+        return TTE_ERROR;
+    }
+    place_text(&ctx->term, &ctx->config);
+    if (!ctx->term.initial) {
+        return TTE_ERROR;
+    }
+
+    if (ctx->config.threads > 1 && !ctx->pool) {
+        ctx->pool = worker_pool_create(ctx->config.threads);
+    }
+    ctx->loaded = 1;
+    return TTE_OK;
+}
+
+// Step to frame and encode whatever changed on screen into ctx->out.
+// Jumping ahead rewinds first: effects are pure in the frame, and the
+// screen diff still covers everything the skipped frames would have drawn.
+static void render_to(tte_ctx *ctx, int frame) {
+    if (frame != ctx->frame) {
+        rewind_effect(&ctx->term);
+    }
+    int parallel = ctx->pool && (ctx->effect->flags & EFFECT_PARALLEL);
+    int active_chars = advance_effect(&ctx->term, &ctx->config, ctx->effect->func,
+                                      parallel ? ctx->pool : NULL, frame);
+    ctx->out.len = 0;
+    if (composite_frame(&ctx->term, &ctx->config)) {
+        capture_frame(&ctx->term, &ctx->slot);
+        format_ansi_frame(&ctx->slot, &ctx->config, &ctx->out);
+    }
+    ctx->changed = ctx->out.len > 0;
+    ctx->finished = animation_finished(active_chars, frame);
+    // Once every character has settled and no background animates, the
+    // remaining frames until the end are identical. A screen that merely
+    // stopped changing proves nothing: an effect may resume at any frame,
+    // and only stepping it would tell.
+    ctx->settled = active_chars == 0 && ctx->config.background_effect == BACKGROUND_NONE && !ctx->changed;
+    ctx->frame = frame + 1;
+    ctx->pending = 1;
+}
+
+// Hand the pending frame to the caller if it fits
+static int take_frame(tte_ctx *ctx, char *buffer, size_t size, size_t *len) {
+    *len = ctx->out.len;
+    if (ctx->out.len > size) {
+        return TTE_SHORT_BUFFER;
+    }
+    if (ctx->out.len) {
+        memcpy(buffer, ctx->out.data, ctx->out.len);
+    }
+    ctx->pending = 0;
+    return TTE_OK;
+}
+
+int tte_step(tte_ctx *ctx, char *buffer, size_t size, size_t *len) {
+    if (!ctx || !ctx->loaded) {
+        return TTE_ERROR;
+    }
+    if (!ctx->pending) {
+        if (ctx->finished) {
+            *len = 0;
+            return TTE_DONE;
+        }
+        render_to(ctx, ctx->frame);
+    }
+    return take_frame(ctx, buffer, size, len);
+}
+
+static long long timespec_ns(const struct timespec *t) {
+    return (long long)t->tv_sec * 1000000000LL + t->tv_nsec;
+}
+
+// When frame is due, on the clock tte_tick was first called with. Rounded
+// up, so a host woken at the deadline always finds the frame due.
+static struct timespec frame_deadline(const tte_ctx *ctx, int frame) {
+    long long rate = ctx->config.frame_rate;
+    long long at = timespec_ns(&ctx->epoch) +
+                   ((long long)(frame - ctx->config.start_frame) * 1000000000LL + rate - 1) / rate;
+    struct timespec deadline = {at / 1000000000LL, at % 1000000000LL};
+    return deadline;
+}
+
+int tte_tick(tte_ctx *ctx, const struct timespec *now, char *buffer, size_t size, tte_tick_t *tick) {
+    if (!ctx || !ctx->loaded || !now || !tick) {
+        return TTE_ERROR;
+    }
+    tick->len = 0;
+    tick->changed = 0;
+    tick->next = *now;
+    if (!ctx->started) {
+        ctx->epoch = *now;
+        ctx->started = 1;
+    }
+
+    if (!ctx->pending) {
+        if (ctx->finished) {
+            return TTE_DONE;
+        }
+        // The latest frame due by now; too early means nothing to do yet
+        long long elapsed = timespec_ns(now) - timespec_ns(&ctx->epoch);
+        long long due = ctx->config.start_frame + elapsed * ctx->config.frame_rate / 1000000000LL;
+        if (elapsed < 0 || due < ctx->frame) {
+            tick->next = frame_deadline(ctx, ctx->frame);
+            return TTE_OK;
+        }
+        render_to(ctx, due < MAX_FRAMES - 1 ? (int)due : MAX_FRAMES - 1);
+    }
+
+    int result = take_frame(ctx, buffer, size, &tick->len);
+    tick->changed = ctx->changed;
+    if (!ctx->finished) {
+        // A settled animation sleeps straight through to its last frame
+        int next = ctx->frame;
+        if (ctx->settled && next <= MIN_FRAMES) {
+            next = MIN_FRAMES + 1;
+        }
+        tick->next = frame_deadline(ctx, next);
+    }
+    return result;
+}
+
+int tte_frame_rate(const tte_ctx *ctx) {
+    return ctx ? ctx->config.frame_rate : DEFAULT_FRAME_RATE;
+}
+
+void tte_destroy(tte_ctx *ctx) {
+    if (!ctx) {
+        return;
+    }
+    cleanup_terminal(&ctx->term);
+    worker_pool_destroy(ctx->pool);
+    free_frame_slot(&ctx->slot);
+    buffer_free(&ctx->out);
+    for (int i = 0; i < ctx->option_count; i++) {
+        free(ctx->options[i]);
+    }
+    free(ctx->options);
+    free(ctx);
+}
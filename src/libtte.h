@@ -0,0 +1,78 @@
+#ifndef LIBTTE_H
+#define LIBTTE_H
+
+#include <stddef.h>
+#include <time.h>
+
+// Embeddable terminal text effects (libtte.a / libtte.so).
+//
+// A context owns its options, characters and framebuffer, and contexts
+// share no state: different threads may each drive their own context at
+// the same time. One context must not be used from two threads at once.
+//
+//     tte_ctx *ctx = tte_create("decrypt", 80, 24);
+//     tte_load_text(ctx, text, strlen(text));
+//     char frame[65536];
+//     size_t len;
+//     while (tte_step(ctx, frame, sizeof(frame), &len) == TTE_OK) {
+//         write(fd, frame, len);     // and wait 1/frame rate
+//     }
+//     tte_destroy(ctx);
+//
+// Frames are escape sequences that draw only what changed since the
+// previous frame, at absolute positions on a width x height screen.
+
+// tte_step and tte_tick results
+#define TTE_OK 0              // A frame was written (it may be empty)
+#define TTE_DONE 1            // The animation has ended; nothing written
+#define TTE_ERROR (-1)        // No text loaded, or out of memory
+#define TTE_SHORT_BUFFER (-2) // Frame needs *len bytes; it is kept for the next call
+
+typedef struct tte_ctx tte_ctx;
+
+// New context for effect on a width x height screen. Returns NULL if the
+// effect does not exist or memory runs out.
+tte_ctx *tte_create(const char *effect, int width, int height);
+
+// Apply command-line style options ("--seed", "7", "--gradient-preset",
+// "fire", ...) before text is loaded. Returns TTE_ERROR once text is
+// loaded, or for --help, an unknown option or an invalid value, in which
+// case none of the options are applied. The strings are copied; argv need
+// not outlive the call.
+int tte_set_options(tte_ctx *ctx, int argc, const char *const argv[]);
+
+// Lay out text (len bytes, lines separated by '\n') and rewind the
+// animation to its first frame. Returns TTE_OK or TTE_ERROR.
+int tte_load_text(tte_ctx *ctx, const char *text, size_t len);
+
+// Step one frame and write its escape sequences to buffer.
+int tte_step(tte_ctx *ctx, char *buffer, size_t size, size_t *len);
+
+// Result of tte_tick
+typedef struct {
+    size_t len;               // Bytes written to the buffer
+    int changed;              // The frame drew something on screen
+    struct timespec next;     // When to call tte_tick again
+} tte_tick_t;
+
+// Non-blocking stepping for event loops. now is the current
+// CLOCK_MONOTONIC time; the first call starts the animation. If a frame is
+// due it is written to buffer (frames the host was too late for are
+// skipped, with the screen kept correct), otherwise nothing is written.
+// tick->next is the absolute time of the next frame; once the animation
+// has settled it jumps to the final frame instead of every 1/frame rate.
+// Settled means every character has finished, not merely that the screen
+// stopped changing: effects that keep characters in motion invisibly (a
+// fade at its final color, a beam parked off the text) still wake the
+// host every frame until they end, with tick->changed 0. Hosts that care
+// can skip writing those frames; a change may come after any of them.
+// Returns TTE_OK, TTE_DONE after the last frame, TTE_SHORT_BUFFER (the
+// frame is kept, tick->len bytes needed) or TTE_ERROR.
+int tte_tick(tte_ctx *ctx, const struct timespec *now, char *buffer, size_t size, tte_tick_t *tick);
+
+// Frames per second the animation is meant to be shown at
+int tte_frame_rate(const tte_ctx *ctx);
+
+void tte_destroy(tte_ctx *ctx);
+
+#endif
@@ -0,0 +1,139 @@
+#include "tte.h"
+
+// Small LZ77 codec for saved animations, in the spirit of LZ4 blocks.
+// A block is a series of sequences: a token byte with the literal count
+// in its high nibble and the match length minus LZ_MIN_MATCH in its low
+// nibble (15 means more length bytes follow, each adding up to 255), the
+// literals, then a 2-byte little-endian match offset and any extra match
+// length bytes. The last sequence has literals only.
+
+#define LZ_MIN_MATCH 4
+#define LZ_HASH_BITS 14
+#define LZ_MAX_OFFSET 65535
+
+static uint32_t lz_hash(const unsigned char *p) {
+    uint32_t v;
+    memcpy(&v, p, sizeof(v));
+    return (v * 2654435761u) >> (32 - LZ_HASH_BITS);
+}
+
+static void put_length(byte_buffer_t *out, size_t len) {
+    unsigned char byte = 255;
+    while (len >= 255) {
+        buffer_append(out, (const char *)&byte, 1);
+        len -= 255;
+    }
+    byte = (unsigned char)len;
+    buffer_append(out, (const char *)&byte, 1);
+}
+
+static void put_sequence(byte_buffer_t *out, const unsigned char *literals, size_t literal_len,
+                         size_t offset, size_t match_len) {
+    size_t match_extra = match_len ? match_len - LZ_MIN_MATCH : 0;
+    unsigned char token = (unsigned char)(((literal_len < 15 ? literal_len : 15) << 4) |
+                                          (match_extra < 15 ? match_extra : 15));
+    buffer_append(out, (const char *)&token, 1);
+    if (literal_len >= 15) {
+        put_length(out, literal_len - 15);
+    }
+    buffer_append(out, (const char *)literals, literal_len);
+    if (match_len) {
+        unsigned char le[2] = {offset & 0xff, offset >> 8};
+        buffer_append(out, (const char *)le, 2);
+        if (match_extra >= 15) {
+            put_length(out, match_extra - 15);
+        }
+    }
+}
+
+// Append the compressed form of src to out. Returns -1 if out of memory.
+int lz_compress(const char *src, size_t len, byte_buffer_t *out) {
+    uint32_t *table = calloc(1u << LZ_HASH_BITS, sizeof(uint32_t));  // Position + 1
+    if (!table) {
+        return -1;
+    }
+
+    const unsigned char *in = (const unsigned char *)src;
+    size_t start = out->len;
+    size_t anchor = 0;
+    size_t i = 0;
+    while (i + LZ_MIN_MATCH <= len) {
+        uint32_t h = lz_hash(in + i);
+        size_t candidate = table[h];
+        table[h] = (uint32_t)(i + 1);
+        if (candidate && i - (candidate - 1) <= LZ_MAX_OFFSET &&
+            memcmp(in + candidate - 1, in + i, LZ_MIN_MATCH) == 0) {
+            candidate--;
+            size_t match_len = LZ_MIN_MATCH;
+            while (i + match_len < len && in[candidate + match_len] == in[i + match_len]) {
+                match_len++;
+            }
+            put_sequence(out, in + anchor, i - anchor, i - candidate, match_len);
+            i += match_len;
+            anchor = i;
+        } else {
+            i++;
+        }
+    }
+    put_sequence(out, in + anchor, len - anchor, 0, 0);
+    free(table);
+
+    // buffer_append drops data it cannot grow for; a short block means that
+    return out->len > start ? 0 : -1;
+}
+
+static int get_length(const unsigned char **in, const unsigned char *end, size_t *len) {
+    unsigned char byte;
+    do {
+        if (*in >= end) {
+            return 0;
+        }
+        byte = *(*in)++;
+        *len += byte;
+    } while (byte == 255);
+    return 1;
+}
+
+// Decompress a block into exactly dst_len bytes. Returns -1 if the block
+// is malformed or does not fill dst.
+int lz_decompress(const char *src, size_t len, char *dst, size_t dst_len) {
+    const unsigned char *in = (const unsigned char *)src;
+    const unsigned char *end = in + len;
+    size_t pos = 0;
+
+    while (in < end) {
+        unsigned char token = *in++;
+        size_t literal_len = token >> 4;
+        if (literal_len == 15 && !get_length(&in, end, &literal_len)) {
+            return -1;
+        }
+        if (literal_len > (size_t)(end - in) || literal_len > dst_len - pos) {
+            return -1;
+        }
+        memcpy(dst + pos, in, literal_len);
+        in += literal_len;
+        pos += literal_len;
+        if (in == end) {
+            break;  // Last sequence: literals only
+        }
+
+        if (end - in < 2) {
+            return -1;
+        }
+        size_t offset = in[0] | (in[1] << 8);
+        in += 2;
+        size_t match_len = token & 15;
+        if (match_len == 15 && !get_length(&in, end, &match_len)) {
+            return -1;
+        }
+        match_len += LZ_MIN_MATCH;
+        if (offset == 0 || offset > pos || match_len > dst_len - pos) {
+            return -1;
+        }
+        // Byte by byte: a match may overlap the bytes it produces
+        for (size_t k = 0; k < match_len; k++, pos++) {
+            dst[pos] = dst[pos - offset];
+        }
+    }
+    return pos == dst_len ? 0 : -1;
+}
@@ -1,127 +1,190 @@
 #include "tte.h"
 
-int main(int argc, char *argv[]) {
-    config_t config = {
-        .frame_rate = DEFAULT_FRAME_RATE,
-        .canvas_width = 0,
-        .canvas_height = 0,
-        .no_final_newline = 0,
-        .effect_name = NULL,
-        .anchor_canvas = ANCHOR_C,
-        .anchor_text = ANCHOR_C,
-        .use_gradient = 1,
-        .gradient_direction = GRADIENT_HORIZONTAL,
-        .gradient_angle = 0.0f,
-        .gradient_steps = 64,
-        .gradient_preset = GRADIENT_PRESET_CUSTOM,
-        .background_effect = BACKGROUND_NONE,
-        .background_intensity = 50,
-        .gradient_colors_string = NULL,
-        .auto_gradient = 0,
-        .ignore_terminal_dimensions = 0,
-        .wrap_text = 0,
-        .tab_width = 4,
-        .xterm_colors = 0,
-        .no_color = 0
-    };
-    
+// Open the --sink backend, standard output by default
+static int open_sink(output_t *out, config_t *config, struct timespec *start) {
+    clock_gettime(CLOCK_MONOTONIC, start);
+    if (output_init_sink(out, config->sink) != 0) {
+        fprintf(stderr, "Cannot open sink %s: %s\n", config->sink, strerror(errno));
+        return -1;
+    }
+    output_write(out, ANSI_HIDE_CURSOR, sizeof(ANSI_HIDE_CURSOR) - 1);
+    return 0;
+}
+
+// Restore the cursor, optionally suppress the final newline, and report
+// what a sink other than the terminal took in
+static int close_sink(output_t *out, config_t *config, const struct timespec *start) {
+    output_write(out, ANSI_SHOW_CURSOR, sizeof(ANSI_SHOW_CURSOR) - 1);
+    if (!config->no_final_newline) {
+        output_write(out, "\n", 1);
+    }
+    int status = output_close(out);
+    if (config->sink && strcmp(config->sink, "tty") != 0) {
+        struct timespec end;
+        clock_gettime(CLOCK_MONOTONIC, &end);
+        double seconds = (end.tv_sec - start->tv_sec) + (end.tv_nsec - start->tv_nsec) / 1e9;
+        fprintf(stderr, "%s sink: %llu bytes in %lu writes, %.3f s\n", out->ops->name, out->bytes,
+                out->writes, seconds);
+        if (status != 0) {
+            fprintf(stderr, "Error writing %s\n", config->sink);
+        }
+    }
+    return status;
+}
+
+// Everything but the options and the --stats report
+static int run(int argc, char *argv[], config_t *config) {
     terminal_t term = {0};
     
-    // Parse command line arguments
-    parse_args(argc, argv, &config);
+    if (config->serve_path) {
+        // Daemon: draw animations for --connect clients until killed
+        if (serve(config->serve_path) != 0) {
+            fprintf(stderr, "Cannot serve on %s: %s\n", config->serve_path, strerror(errno));
+        }
+        return 1;
+    }
     
-    if (!config.effect_name) {
+    if (config->batch_path) {
+        // Each job names its own input and effect
+        return run_batch(config, config->batch_path);
+    }
+    
+    if (config->play_path) {
+        // Saved animations need no effect and no input
+        output_t out;
+        struct timespec start;
+        if (open_sink(&out, config, &start) != 0) {
+            return 1;
+        }
+        int status = play_animation(config->play_path, config, &out);
+        if (status != 0) {
+            fprintf(stderr, "Cannot play %s: %s\n", config->play_path, strerror(errno));
+        }
+        status |= close_sink(&out, config, &start);
+        return status != 0;
+    }
+    
+    if (!config->effect_name) {
         print_usage(argv[0]);
         return 1;
     }
     
     // Get effect function
-    effect_func_t effect_func = get_effect_function(config.effect_name);
+    const effect_info_t *effect = find_effect(config->effect_name);
+    effect_func_t effect_func = effect ? effect->func : NULL;
     if (!effect_func) {
-        fprintf(stderr, "Unknown effect: %s\n", config.effect_name);
+        fprintf(stderr, "Unknown effect: %s\n", config->effect_name);
         return 1;
     }
     
-    // Handle gradient options
-    if (config.auto_gradient) {
-        // Generate random gradient
-        generate_auto_gradient(&config, time(NULL));
-    } else if (config.gradient_preset != GRADIENT_PRESET_CUSTOM) {
-        // Use specified preset
-        setup_gradient_preset(&config, config.gradient_preset);
-    } else if (config.gradient_colors_string) {
-        // Parse custom colors
-        parse_gradient_colors(&config, config.gradient_colors_string);
-    } else {
-        // Set up sophisticated gradients based on effect (default behavior)
-        setup_gradient_colors(&config, config.effect_name);
+    int headless = config->record_path || config->save_path || config->bake_path || config->shm_name;
+    byte_buffer_t input = {0};
+    if (config->cache || config->connect_path || config->output_count) {
+        // The cache key covers the raw input, the daemon is sent all of it,
+        // and every --output size lays it out afresh
+        buffer_read_file(&input, stdin);
+    }
+    if (config->connect_path && !headless && !config->sink && !config->output_count) {
+        int status;
+        if (serve_connect(config->connect_path, argc, argv, &input, STDOUT_FILENO, &status) == 0) {
+            buffer_free(&input);
+            return status;
+        }
+        // No daemon answering; draw it ourselves
     }
     
+    if (config->output_count && !headless) {
+        // Other terminals, each sized and laid out on its own
+        int status = fanout_animation(config, effect, &input);
+        buffer_free(&input);
+        return status;
+    }
+    
+    // Handle gradient options
+    resolve_gradient(config);
+    
     // Initialize terminal and read input
     init_terminal(&term);
-    read_input_text_with_config(&term, &config);
-    
-    // Set canvas dimensions (0 means use full terminal)
-    if (config.canvas_width > 0) {
-        term.canvas_width = config.canvas_width;
-    } else if (config.canvas_width == 0) {
+    term.seed = config->seed;
+    if (headless) {
+        // Recording renders into a virtual terminal, not the one we run in
+        term.terminal_width = config->record_width;
+        term.terminal_height = config->record_height;
         term.canvas_width = term.terminal_width;
-    }
-    if (config.canvas_height > 0) {
-        term.canvas_height = config.canvas_height;
-    } else if (config.canvas_height == 0) {
         term.canvas_height = term.terminal_height;
     }
+    set_terminal_easing(&term, config->custom_easing ? config->easing : get_effect_easing(config->effect_name));
+    if (config->cache || config->connect_path) {
+        FILE *text = input.len ? fmemopen(input.data, input.len, "r") : NULL;
+        if (text) {
+            read_input_text_from(&term, config, text);
+            fclose(text);
+        } else {
+            read_input_text_from(&term, config, stdin);  // Empty input
+        }
+    } else {
+        read_input_text_with_config(&term, config);
+    }
     
-    // Calculate text and canvas positioning offsets
-    calculate_offsets(&term, config.anchor_canvas, config.anchor_text);
+    // Size the canvas, anchor the text and apply its initial gradient
+    place_text(&term, config);
     
-    // Apply initial gradient to all characters
-    apply_initial_gradient(&term, &config);
+    // Worker threads encode row bands; effects whose characters step
+    // independently also step on them
+    worker_pool_t *pool = NULL;
+    if (config->threads > 1) {
+        pool = worker_pool_create(config->threads);
+        term.pool = pool;
+    }
     
-    // Setup terminal for animation
-    printf(ANSI_HIDE_CURSOR);
-    fflush(stdout);
-    
-    // Run animation
-    int frame = 0;
-    int max_frames = 1000; // Reasonable limit
-    
-    while (frame < max_frames) {
-        term.frame_count = frame; // Pass frame to terminal for background rendering
-        
-        effect_func(&term, frame);
-        
-        // Check if animation is complete
-        int active_chars = 0;
-        for (int i = 0; i < term.char_count; i++) {
-            if (term.chars[i].active) {
-                active_chars++;
-            }
-        }
-        
-        // Apply final gradient when all effects are done
-        if (active_chars == 0) {
-            apply_final_gradient(&term, &config);
-        }
-        
-        render_frame_with_config(&term, &config);
-        
-        if (active_chars == 0 && frame > 60) {
-            break;
-        }
-        
-        sleep_frame(config.frame_rate);
-        frame++;
+    if (headless) {
+        int status = render_headless(&term, config, effect, pool);
+        term.pool = NULL;
+        worker_pool_destroy(pool);
+        cleanup_terminal(&term);
+        buffer_free(&input);
+        return status;
     }
     
-    // Restore cursor and optionally suppress final newline
-    printf(ANSI_SHOW_CURSOR);
-    if (!config.no_final_newline) {
-        printf("\n");
+    // Setup terminal for animation
+    output_t out;
+    struct timespec start;
+    int status = 1;  // Unless the sink opens
+    if (open_sink(&out, config, &start) == 0) {
+        show_animation(&term, config, effect, pool, &input, &out);
+        // Only an explicit --sink turns write errors into a failed run
+        status = close_sink(&out, config, &start) != 0 && config->sink;
     }
-    fflush(stdout);
     
+    term.pool = NULL;
+    worker_pool_destroy(pool);
     cleanup_terminal(&term);
-    return 0;
-}
\ No newline at end of file
+    buffer_free(&input);
+    return status;
+}
+
+int main(int argc, char *argv[]) {
+    config_t config;
+    init_config(&config);
+    
+    // Parse command line arguments
+    if (parse_args(argc, argv, &config) != 0) {
+        return 1;
+    }
+    
+    stats_t stats;
+    if (config.stats_format != STATS_OFF) {
+        stats_init(&stats);
+        config.stats = &stats;
+    }
+    
+    int status = run(argc, argv, &config);
+    
+    if (config.stats) {
+        if (stats_report(&stats, &config) != 0) {
+            fprintf(stderr, "Cannot write %s: %s\n", config.stats_path, strerror(errno));
+        }
+        stats_free(&stats);
+    }
+    return status;
+}
@@ -0,0 +1,249 @@
+#include "tte.h"
+
+// Output backends. Everything that leaves the process as escape codes goes
+// through an output_t: frames from write_frame, cursor prologue and
+// epilogue, offline and saved-animation playback. Every backend counts the
+// bytes and writes it is handed, so the null sink measures effect and
+// encode throughput without a terminal in the way.
+
+// Write to a file descriptor with as few syscalls as possible, retrying
+// partial writes and signals
+static int tty_write(output_t *out, const struct iovec *iov, int count) {
+    struct iovec pieces[MAX_THREADS + 2];
+    if (count > (int)(sizeof(pieces) / sizeof(pieces[0]))) {
+        for (int i = 0; i < count; i++) {
+            write_bytes(out->fd, iov[i].iov_base, iov[i].iov_len);
+        }
+        return 0;
+    }
+    memcpy(pieces, iov, count * sizeof(struct iovec));
+    struct iovec *next = pieces;
+    while (count > 0) {
+        ssize_t written = writev(out->fd, next, count);
+        if (written < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return -1;  // Terminal went away; drop the frame
+        }
+        // Skip fully written pieces and trim a partially written one
+        while (count > 0 && (size_t)written >= next->iov_len) {
+            written -= next->iov_len;
+            next++;
+            count--;
+        }
+        if (count > 0) {
+            next->iov_base = (char *)next->iov_base + written;
+            next->iov_len -= written;
+        }
+    }
+    return 0;
+}
+
+static void tty_close(output_t *out) {
+    (void)out;  // The descriptor belongs to the caller
+}
+
+// Buffered through stdio: a file gains nothing from one syscall per frame
+static int file_write(output_t *out, const struct iovec *iov, int count) {
+    for (int i = 0; i < count; i++) {
+        if (iov[i].iov_len && fwrite(iov[i].iov_base, 1, iov[i].iov_len, out->file) != iov[i].iov_len) {
+            return -1;
+        }
+    }
+    return 0;
+}
+
+static void file_close(output_t *out) {
+    if (out->file && fclose(out->file) != 0) {
+        out->failed = 1;
+    }
+    out->file = NULL;
+}
+
+static int memory_write(output_t *out, const struct iovec *iov, int count) {
+    for (int i = 0; i < count; i++) {
+        buffer_append(&out->buffer, iov[i].iov_base, iov[i].iov_len);
+    }
+    return 0;
+}
+
+static void memory_close(output_t *out) {
+    buffer_free(&out->buffer);
+}
+
+static int null_write(output_t *out, const struct iovec *iov, int count) {
+    (void)out;
+    (void)iov;
+    (void)count;
+    return 0;
+}
+
+static void null_close(output_t *out) {
+    (void)out;
+}
+
+// Write what the descriptor takes without blocking. Returns the bytes
+// written, or -1 if it is gone.
+static ssize_t write_some(int fd, const char *data, size_t len) {
+    size_t done = 0;
+    while (done < len) {
+        ssize_t written = write(fd, data + done, len - done);
+        if (written < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            if (errno == EAGAIN || errno == EWOULDBLOCK) {
+                break;
+            }
+            return -1;
+        }
+        done += written;
+    }
+    return (ssize_t)done;
+}
+
+// Push out queued bytes; 1 once the queue is empty
+static int nonblocking_flush(output_t *out) {
+    if (out->sent < out->buffer.len) {
+        ssize_t written = write_some(out->fd, out->buffer.data + out->sent, out->buffer.len - out->sent);
+        if (written < 0) {
+            out->failed = 1;
+            return 0;
+        }
+        out->sent += written;
+        if (out->sent < out->buffer.len) {
+            return 0;
+        }
+    }
+    out->buffer.len = 0;
+    out->sent = 0;
+    return 1;
+}
+
+// Never waits: whatever the descriptor does not take now is queued behind
+// anything already waiting, for output_flush to push out later
+static int nonblocking_write(output_t *out, const struct iovec *iov, int count) {
+    for (int i = 0; i < count; i++) {
+        const char *data = iov[i].iov_base;
+        size_t len = iov[i].iov_len;
+        if (out->buffer.len == 0) {
+            ssize_t written = write_some(out->fd, data, len);
+            if (written < 0) {
+                return -1;
+            }
+            data += written;
+            len -= written;
+        }
+        buffer_append(&out->buffer, data, len);
+    }
+    return 0;
+}
+
+static void nonblocking_close(output_t *out) {
+    buffer_free(&out->buffer);  // The descriptor belongs to the caller
+}
+
+static const output_ops_t tty_ops = {"tty", tty_write, tty_close, NULL};
+static const output_ops_t file_ops = {"file", file_write, file_close, NULL};
+static const output_ops_t memory_ops = {"memory", memory_write, memory_close, NULL};
+static const output_ops_t null_ops = {"null", null_write, null_close, NULL};
+static const output_ops_t nonblocking_ops = {"nonblocking", nonblocking_write, nonblocking_close,
+                                             nonblocking_flush};
+
+// Unbuffered writes to fd, which stays open afterwards
+void output_init_tty(output_t *out, int fd) {
+    memset(out, 0, sizeof(*out));
+    out->ops = &tty_ops;
+    out->fd = fd;
+}
+
+// Create or truncate path. Returns -1 if it cannot be opened.
+int output_init_file(output_t *out, const char *path) {
+    memset(out, 0, sizeof(*out));
+    out->ops = &file_ops;
+    out->fd = -1;
+    out->file = fopen(path, "w");
+    return out->file ? 0 : -1;
+}
+
+// Collect everything in out->buffer
+void output_init_memory(output_t *out) {
+    memset(out, 0, sizeof(*out));
+    out->ops = &memory_ops;
+    out->fd = -1;
+}
+
+// Discard everything, counting it
+void output_init_null(output_t *out) {
+    memset(out, 0, sizeof(*out));
+    out->ops = &null_ops;
+    out->fd = -1;
+}
+
+// Write to fd, which must be in O_NONBLOCK mode, queueing what it cannot
+// take yet instead of waiting
+void output_init_nonblocking(output_t *out, int fd) {
+    memset(out, 0, sizeof(*out));
+    out->ops = &nonblocking_ops;
+    out->fd = fd;
+}
+
+// Open the backend named by --sink: tty (standard output), null, memory
+// or file:PATH. Returns -1 for an unknown name or a file that cannot be
+// created.
+int output_init_sink(output_t *out, const char *sink) {
+    if (!sink || strcmp(sink, "tty") == 0) {
+        output_init_tty(out, STDOUT_FILENO);
+    } else if (strcmp(sink, "null") == 0) {
+        output_init_null(out);
+    } else if (strcmp(sink, "memory") == 0) {
+        output_init_memory(out);
+    } else if (strncmp(sink, "file:", 5) == 0 && sink[5]) {
+        return output_init_file(out, sink + 5);
+    } else {
+        memset(out, 0, sizeof(*out));
+        errno = EINVAL;
+        return -1;
+    }
+    return 0;
+}
+
+int output_writev(output_t *out, const struct iovec *iov, int count) {
+    for (int i = 0; i < count; i++) {
+        out->bytes += iov[i].iov_len;
+    }
+    out->writes++;
+    if (out->ops->write(out, iov, count) != 0) {
+        out->failed = 1;
+        return -1;
+    }
+    return 0;
+}
+
+int output_write(output_t *out, const char *data, size_t len) {
+    struct iovec iov = {(void *)data, len};
+    return output_writev(out, &iov, 1);
+}
+
+// Push out anything a backend has queued. Returns 1 once nothing is left,
+// 0 while some is still waiting or after a failure.
+int output_flush(output_t *out) {
+    if (out->failed) {
+        return 0;
+    }
+    return out->ops->flush ? out->ops->flush(out) : 1;
+}
+
+// Bytes written but not yet taken by the destination
+size_t output_pending(const output_t *out) {
+    return out->ops->flush ? out->buffer.len - out->sent : 0;
+}
+
+// Release the backend. Returns -1 if anything failed to be written.
+int output_close(output_t *out) {
+    if (out->ops) {
+        out->ops->close(out);
+    }
+    return out->failed ? -1 : 0;
+}
@@ -0,0 +1,284 @@
+#include "tte.h"
+
+// Cursors and the sleeper count are sequentially consistent so a stage
+// going to sleep and a stage advancing a cursor cannot miss each other
+static unsigned long load_cursor(unsigned long *cursor) {
+    return __atomic_load_n(cursor, __ATOMIC_SEQ_CST);
+}
+
+// Publish one more frame on a cursor owned by the calling stage
+static void advance_cursor(frame_pipeline_t *pipeline, unsigned long *cursor) {
+    __atomic_store_n(cursor, *cursor + 1, __ATOMIC_SEQ_CST);
+    if (__atomic_load_n(&pipeline->sleepers, __ATOMIC_SEQ_CST)) {
+        pthread_mutex_lock(&pipeline->lock);
+        pthread_cond_broadcast(&pipeline->wake);
+        pthread_mutex_unlock(&pipeline->lock);
+    }
+}
+
+// Wait until another stage's cursor reaches target. The check is lock-free;
+// only a stage that has to wait takes the lock. Returns 0 on shutdown.
+static int wait_cursor(frame_pipeline_t *pipeline, unsigned long *cursor, unsigned long target) {
+    if (load_cursor(cursor) >= target) {
+        return 1;
+    }
+    pthread_mutex_lock(&pipeline->lock);
+    __atomic_add_fetch(&pipeline->sleepers, 1, __ATOMIC_SEQ_CST);
+    while (load_cursor(cursor) < target && !pipeline->shutdown) {
+        pthread_cond_wait(&pipeline->wake, &pipeline->lock);
+    }
+    __atomic_sub_fetch(&pipeline->sleepers, 1, __ATOMIC_SEQ_CST);
+    int reached = load_cursor(cursor) >= target;
+    pthread_mutex_unlock(&pipeline->lock);
+    return reached;
+}
+
+static void *encoder_main(void *arg) {
+    frame_pipeline_t *pipeline = arg;
+    while (wait_cursor(pipeline, &pipeline->composited, pipeline->encoded + 1)) {
+        frame_slot_t *slot = &pipeline->slots[pipeline->encoded % pipeline->depth];
+        encode_frame(slot, pipeline->config, pipeline->pool);
+        advance_cursor(pipeline, &pipeline->encoded);
+    }
+    return NULL;
+}
+
+// Sleep until frame's slot in the schedule; frames already late go out at
+// once without shifting the ones after them
+static void wait_for_deadline(frame_pipeline_t *pipeline, int frame) {
+    int frame_rate = pipeline->config ? pipeline->config->frame_rate : 0;
+    if (frame_rate <= 0) {
+        return;
+    }
+    if (pipeline->first_frame < 0) {
+        pipeline->first_frame = frame;
+    }
+    if (sleep_until_frame(&pipeline->epoch, frame - pipeline->first_frame, frame_rate)) {
+        stats_missed(pipeline->config);
+    }
+}
+
+static int cancelled(frame_pipeline_t *pipeline) {
+    return __atomic_load_n(&pipeline->shutdown, __ATOMIC_SEQ_CST);
+}
+
+static void *writer_main(void *arg) {
+    frame_pipeline_t *pipeline = arg;
+    while (wait_cursor(pipeline, &pipeline->encoded, pipeline->written + 1) && !cancelled(pipeline)) {
+        frame_slot_t *slot = &pipeline->slots[pipeline->written % pipeline->depth];
+        wait_for_deadline(pipeline, slot->frame);
+        if (cancelled(pipeline)) {
+            break;
+        }
+        write_frame_timed(slot, pipeline->config, pipeline->out);
+        advance_cursor(pipeline, &pipeline->written);
+    }
+    return NULL;
+}
+
+// Start the encoder and I/O threads. Frame n is written (n - first) /
+// frame_rate after now, first being the first frame submitted; the caller
+// composites into up to depth slots ahead of the terminal. Returns NULL if
+// the threads cannot start.
+frame_pipeline_t *frame_pipeline_create(config_t *config, worker_pool_t *pool, output_t *out, int depth) {
+    if (depth < 2) {
+        depth = 2;
+    }
+
+    frame_pipeline_t *pipeline = calloc(1, sizeof(frame_pipeline_t));
+    if (!pipeline) {
+        return NULL;
+    }
+    pipeline->slots = calloc(depth, sizeof(frame_slot_t));
+    if (!pipeline->slots) {
+        free(pipeline);
+        return NULL;
+    }
+    pipeline->depth = depth;
+    pipeline->config = config;
+    pipeline->pool = pool;
+    pipeline->out = out;
+    clock_gettime(CLOCK_MONOTONIC, &pipeline->epoch);
+    pipeline->first_frame = -1;
+    pthread_mutex_init(&pipeline->lock, NULL);
+    pthread_cond_init(&pipeline->wake, NULL);
+
+    if (pthread_create(&pipeline->encoder, NULL, encoder_main, pipeline) != 0) {
+        pthread_mutex_destroy(&pipeline->lock);
+        pthread_cond_destroy(&pipeline->wake);
+        free(pipeline->slots);
+        free(pipeline);
+        return NULL;
+    }
+    if (pthread_create(&pipeline->writer, NULL, writer_main, pipeline) != 0) {
+        pthread_mutex_lock(&pipeline->lock);
+        __atomic_store_n(&pipeline->shutdown, 1, __ATOMIC_SEQ_CST);
+        pthread_cond_broadcast(&pipeline->wake);
+        pthread_mutex_unlock(&pipeline->lock);
+        pthread_join(pipeline->encoder, NULL);
+        pthread_mutex_destroy(&pipeline->lock);
+        pthread_cond_destroy(&pipeline->wake);
+        free(pipeline->slots);
+        free(pipeline);
+        return NULL;
+    }
+    return pipeline;
+}
+
+// Composite the terminal and hand the frame to the encoder. Blocks only
+// when every slot is still waiting to be encoded or written, which is how
+// the caller's loop is paced.
+void frame_pipeline_submit(frame_pipeline_t *pipeline, terminal_t *term) {
+    if (!composite_frame(term, pipeline->config)) {
+        return;
+    }
+    if (pipeline->composited >= (unsigned long)pipeline->depth &&
+        !wait_cursor(pipeline, &pipeline->written, pipeline->composited - pipeline->depth + 1)) {
+        return;
+    }
+    capture_frame(term, &pipeline->slots[pipeline->composited % pipeline->depth]);
+    advance_cursor(pipeline, &pipeline->composited);
+}
+
+// Wait until every submitted frame has reached the terminal
+void frame_pipeline_drain(frame_pipeline_t *pipeline) {
+    if (pipeline) {
+        wait_cursor(pipeline, &pipeline->written, pipeline->composited);
+    }
+}
+
+// Drop the frames not yet written; nothing more reaches the output after
+// the one being written now, if any
+void frame_pipeline_cancel(frame_pipeline_t *pipeline) {
+    if (pipeline) {
+        pthread_mutex_lock(&pipeline->lock);
+        __atomic_store_n(&pipeline->shutdown, 1, __ATOMIC_SEQ_CST);
+        pthread_cond_broadcast(&pipeline->wake);
+        pthread_mutex_unlock(&pipeline->lock);
+    }
+}
+
+void frame_pipeline_destroy(frame_pipeline_t *pipeline) {
+    if (!pipeline) {
+        return;
+    }
+    frame_pipeline_drain(pipeline);
+
+    pthread_mutex_lock(&pipeline->lock);
+    __atomic_store_n(&pipeline->shutdown, 1, __ATOMIC_SEQ_CST);
+    pthread_cond_broadcast(&pipeline->wake);
+    pthread_mutex_unlock(&pipeline->lock);
+    pthread_join(pipeline->encoder, NULL);
+    pthread_join(pipeline->writer, NULL);
+
+    for (int i = 0; i < pipeline->depth; i++) {
+        free_frame_slot(&pipeline->slots[i]);
+    }
+    pthread_mutex_destroy(&pipeline->lock);
+    pthread_cond_destroy(&pipeline->wake);
+    free(pipeline->slots);
+    free(pipeline);
+}
+
+// Offline frames go straight to the output
+static void write_output(void *ctx, int frame, const char *data, size_t len) {
+    (void)frame;
+    output_write(ctx, data, len);
+}
+
+// Draw the animation on out: replayed from the cache, rendered offline, or
+// live. input is the raw text when --cache needs it for the key.
+void show_animation(terminal_t *term, config_t *config, const effect_info_t *effect, worker_pool_t *pool,
+                    const byte_buffer_t *input, output_t *out) {
+    if (config->cache && cache_play(term, config, effect->func, pool, input->data, input->len, out) == 0) {
+        return;
+    }
+    if (config->offline) {
+        // Render every frame as fast as possible, frame ranges in parallel
+        if (render_offline(term, config, effect->func, pool, config->start_frame, NULL, write_output, out) != 0) {
+            fprintf(stderr, "Offline rendering failed\n");
+        }
+        return;
+    }
+
+    // Encode and write frames on their own threads so a slow terminal does
+    // not hold up the effect. The I/O thread paces the output, so the effect
+    // uses the time between frames to compute up to lookahead frames ahead.
+    // Without the threads, render inline and sleep between frames.
+    frame_pipeline_t *pipeline = frame_pipeline_create(config, pool, out, config->lookahead + 1);
+    int parallel_step = pool && (effect->flags & EFFECT_PARALLEL);
+
+    // Run animation; effects are pure in the frame, so starting later
+    // simply skips the frames before it
+    for (int frame = config->start_frame; ; frame++) {
+        int active_chars = advance_effect(term, config, effect->func, parallel_step ? pool : NULL, frame);
+
+        if (pipeline) {
+            frame_pipeline_submit(pipeline, term);
+        } else {
+            render_frame_to(term, config, out);
+        }
+
+        if (animation_finished(active_chars, frame)) {
+            break;
+        }
+        if (serve_hung_up(config)) {
+            // The client is gone; stop drawing on its terminal at once
+            frame_pipeline_cancel(pipeline);
+            break;
+        }
+
+        if (!pipeline) {
+            sleep_frame(config->frame_rate);
+        }
+    }
+
+    frame_pipeline_destroy(pipeline);
+}
+
+// Headless: every frame goes to the saved animation, baked C source and/or
+// recording as fast as it renders, stamped with the time it would have been
+// shown live. The shared-memory ring is watched live, so it goes last, at
+// the frame rate.
+int render_headless(terminal_t *term, config_t *config, const effect_info_t *effect, worker_pool_t *pool) {
+    effect_func_t effect_func = effect->func;
+    int status = 0;
+    if (config->save_path) {
+        anim_writer_t writer;
+        if (anim_writer_init(&writer, term->terminal_height, term->terminal_width,
+                             config->frame_rate, config->compress) != 0 ||
+            render_offline(term, config, effect_func, pool, config->start_frame,
+                           format_delta_frame, anim_writer_frame, &writer) != 0) {
+            writer.failed = 1;
+        }
+        if (anim_writer_finish(&writer, config->save_path) != 0) {
+            fprintf(stderr, "Cannot save %s: %s\n", config->save_path, strerror(errno));
+            status = 1;
+        }
+    }
+    if (config->bake_path && bake_animation(term, config, effect_func, pool, config->bake_path) != 0) {
+        fprintf(stderr, "Cannot bake %s: %s\n", config->bake_path, strerror(errno));
+        status = 1;
+    }
+    if (config->record_path) {
+        asciicast_t cast;
+        if (asciicast_open(&cast, config->record_path, term->terminal_width, term->terminal_height,
+                           config->frame_rate) != 0) {
+            fprintf(stderr, "Cannot create %s: %s\n", config->record_path, strerror(errno));
+            return 1;
+        }
+        if (render_offline(term, config, effect_func, pool, config->start_frame, NULL, asciicast_frame, &cast) != 0) {
+            fprintf(stderr, "Offline rendering failed\n");
+            status = 1;
+        }
+        if (asciicast_close(&cast, !config->no_final_newline) != 0) {
+            fprintf(stderr, "Error writing %s\n", config->record_path);
+            status = 1;
+        }
+    }
+    if (config->shm_name && shm_animate(term, config, effect, pool) != 0) {
+        fprintf(stderr, "Cannot publish to %s: %s\n", config->shm_name, strerror(errno));
+        status = 1;
+    }
+    return status;
+}
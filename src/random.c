@@ -0,0 +1,29 @@
+#include "tte.h"
+
+// splitmix64 finalizer: a bijective mix with full avalanche
+static uint64_t mix64(uint64_t x) {
+    x ^= x >> 30;
+    x *= 0xBF58476D1CE4E5B9ULL;
+    x ^= x >> 27;
+    x *= 0x94D049BB133111EBULL;
+    x ^= x >> 31;
+    return x;
+}
+
+// Counter-based random numbers: the value is a pure function of the seed,
+// the stream (what the number is for), an index (usually the character)
+// and a counter (usually the frame), so callers may evaluate them in any
+// order or in parallel and still get identical runs
+uint32_t random_u32(unsigned int seed, random_stream_t stream, uint32_t index, uint32_t counter) {
+    uint64_t key = mix64(((uint64_t)seed << 8) ^ (uint64_t)stream);
+    uint64_t ctr = ((uint64_t)index << 32) | counter;
+    return (uint32_t)(mix64(key ^ mix64(ctr + 0x9E3779B97F4A7C15ULL)) >> 32);
+}
+
+// Uniform integer in [0, n)
+int random_range(unsigned int seed, random_stream_t stream, uint32_t index, uint32_t counter, int n) {
+    if (n <= 0) {
+        return 0;
+    }
+    return (int)(((uint64_t)random_u32(seed, stream, index, counter) * (uint64_t)n) >> 32);
+}
@@ -0,0 +1,74 @@
+#include "tte.h"
+
+// asciicast v2: a JSON header line, then one [time, "o", data] event line
+// per frame. Frame n is stamped (n - first) / frame_rate seconds in, so the
+// recording plays back at the live pace however fast it was rendered.
+
+// Write data as a JSON string. Bytes from 0x80 up are passed through, so
+// UTF-8 input stays UTF-8.
+static void write_json_string(FILE *file, const char *data, size_t len) {
+    fputc('"', file);
+    for (size_t i = 0; i < len; i++) {
+        unsigned char c = (unsigned char)data[i];
+        if (c == '"' || c == '\\') {
+            fputc('\\', file);
+            fputc(c, file);
+        } else if (c == '\n') {
+            fputs("\\n", file);
+        } else if (c == '\r') {
+            fputs("\\r", file);
+        } else if (c < 0x20 || c == 0x7f) {
+            fprintf(file, "\\u%04x", c);
+        } else {
+            fputc(c, file);
+        }
+    }
+    fputc('"', file);
+}
+
+static void write_event(asciicast_t *cast, const char *data, size_t len) {
+    fprintf(cast->file, "[%.6f, \"o\", ", cast->time);
+    write_json_string(cast->file, data, len);
+    fputs("]\n", cast->file);
+}
+
+// Create the recording and write its header. Returns -1 if the file cannot
+// be created.
+int asciicast_open(asciicast_t *cast, const char *path, int width, int height, int frame_rate) {
+    cast->file = fopen(path, "w");
+    if (!cast->file) {
+        return -1;
+    }
+    cast->frame_rate = frame_rate > 0 ? frame_rate : DEFAULT_FRAME_RATE;
+    cast->first_frame = -1;
+    cast->time = 0.0;
+
+    fprintf(cast->file, "{\"version\": 2, \"width\": %d, \"height\": %d, "
+            "\"env\": {\"TERM\": \"xterm-256color\"}}\n", width, height);
+    write_event(cast, ANSI_HIDE_CURSOR, sizeof(ANSI_HIDE_CURSOR) - 1);
+    return 0;
+}
+
+// frame_output_t callback: one event per rendered frame
+void asciicast_frame(void *ctx, int frame, const char *data, size_t len) {
+    asciicast_t *cast = ctx;
+    if (cast->first_frame < 0) {
+        cast->first_frame = frame;
+    }
+    cast->time = (double)(frame - cast->first_frame) / cast->frame_rate;
+    write_event(cast, data, len);
+}
+
+// Restore the cursor as the live run does and close the file. Returns -1
+// if anything failed to reach the disk.
+int asciicast_close(asciicast_t *cast, int final_newline) {
+    if (!cast->file) {
+        return -1;
+    }
+    const char *tail = final_newline ? ANSI_SHOW_CURSOR "\n" : ANSI_SHOW_CURSOR;
+    write_event(cast, tail, strlen(tail));
+    int failed = ferror(cast->file);
+    failed |= fclose(cast->file) != 0;
+    cast->file = NULL;
+    return failed ? -1 : 0;
+}
@@ -0,0 +1,243 @@
+#include "tte.h"
+
+// Effects are pure functions of the initial characters and the frame
+// number: stepping a restored copy straight to frame N gives the same
+// characters as stepping through frames 0..N. Seeking and offline
+// rendering are built on that.
+
+// Remember the characters as they are before frame 0
+void save_initial_state(terminal_t *term) {
+    free(term->initial);
+    term->initial = malloc((term->char_count + 1) * sizeof(character_t));
+    if (term->initial) {
+        memcpy(term->initial, term->chars, term->char_count * sizeof(character_t));
+    }
+}
+
+// Put every character back to its initial state. What each one last drew
+// is kept, so the next frame still redraws exactly what changed on screen.
+void rewind_effect(terminal_t *term) {
+    if (!term->initial) {
+        return;
+    }
+    for (int i = 0; i < term->char_count; i++) {
+        cell_snapshot_t drawn = term->chars[i].drawn;
+        term->chars[i] = term->initial[i];
+        term->chars[i].drawn = drawn;
+    }
+    rewind_reveal_timeline(term);
+    term->damage_valid = 0;
+}
+
+// Evaluate the effect at any frame without stepping the ones before it
+void seek_effect(terminal_t *term, effect_func_t func, int frame) {
+    rewind_effect(term);
+    term->frame_count = frame;
+    func(term, frame);
+    term->damage_valid = 0;  // Everything may differ from the last frame shown
+}
+
+// Step the effect to frame, on the pool if given, and apply the final
+// gradient once every character has settled. Returns the active count.
+int advance_effect(terminal_t *term, config_t *config, effect_func_t func, worker_pool_t *pool, int frame) {
+    term->frame_count = frame;  // Backgrounds animate with the frame too
+    term->damage_valid = 0;
+    double start = stats_start(config);
+    if (pool) {
+        worker_pool_step(pool, term, func, frame);
+    } else {
+        func(term, frame);
+    }
+
+    // Check if animation is complete and note which tiles have settled
+    int active_chars = update_tile_state(term);
+    stats_stop(config, STAT_EFFECT, start);
+
+    // Apply final gradient when all effects are done
+    if (active_chars == 0) {
+        start = stats_start(config);
+        apply_final_gradient(term, config);
+        stats_stop(config, STAT_GRADIENT, start);
+        term->damage_valid = 0;  // Final gradient touches every character
+    }
+    return active_chars;
+}
+
+int animation_finished(int active_chars, int frame) {
+    return (active_chars == 0 && frame > MIN_FRAMES) || frame >= MAX_FRAMES - 1;
+}
+
+// Encode a captured frame as the escape sequences the terminal is sent
+void format_ansi_frame(frame_slot_t *slot, config_t *config, byte_buffer_t *out) {
+    encode_frame(slot, config, NULL);
+    for (int b = 0; b < slot->band_count; b++) {
+        buffer_append(out, slot->bands[b].data, slot->bands[b].len);
+    }
+    buffer_append(out, slot->trailer.data, slot->trailer.len);
+}
+
+// One offline worker: a private terminal and the frames of its current chunk
+typedef struct {
+    terminal_t view;
+    frame_slot_t slot;
+    byte_buffer_t out;            // Encoded frames back to back
+    int frames[OFFLINE_CHUNK];
+    size_t ends[OFFLINE_CHUNK];   // End of each frame in out
+    int count;
+    int last_frame;               // Frame the view was last composited at
+    int finished;                 // The animation ended inside this chunk
+    config_t config;              // The job's, collecting --stats privately
+    stats_t stats;                // This chunk's, kept only if it is handed over
+} offline_worker_t;
+
+typedef struct {
+    offline_worker_t *workers;
+    config_t *config;
+    effect_func_t func;
+    frame_format_t format;
+    int first_chunk;              // Chunk rendered by worker 0 this round
+    int first_frame;
+} offline_job_t;
+
+// A worker terminal with the same layout as term, starting from its
+// initial characters with a fresh screen
+static int init_view(terminal_t *view, terminal_t *term) {
+    terminal_t fresh = {0};
+    init_terminal(&fresh);
+    *view = *term;
+    view->chars = fresh.chars;
+    view->fb = fresh.fb;
+    view->damage = fresh.damage;
+    view->timeline = NULL;
+    view->sweep = NULL;
+    view->lanes = NULL;
+    view->easing = NULL;
+    view->pool = NULL;
+    view->initial = NULL;
+    if (!view->chars || !view->fb || !view->damage) {
+        return 0;
+    }
+    if (term->easing) {
+        set_terminal_easing(view, term->easing->easing);
+    }
+    memcpy(view->chars, term->initial, term->char_count * sizeof(character_t));
+    save_initial_state(view);
+    return view->initial != NULL;
+}
+
+static void render_chunk(void *ctx, int worker) {
+    offline_job_t *job = ctx;
+    offline_worker_t *w = &job->workers[worker];
+    int first = job->first_frame + (job->first_chunk + worker) * OFFLINE_CHUNK;
+
+    w->count = 0;
+    w->out.len = 0;
+    w->finished = (first >= MAX_FRAMES);
+    if (w->finished) {
+        return;
+    }
+
+    // Away from the previous chunk, rebuild the screen as the frame before
+    // this chunk left it so dirty tracking emits the same bytes. That frame
+    // belongs to another chunk, so it is not measured here.
+    if (w->last_frame != first - 1) {
+        rewind_effect(&w->view);
+        if (first > job->first_frame) {
+            stats_t *stats = w->config.stats;
+            w->config.stats = NULL;
+            advance_effect(&w->view, &w->config, job->func, NULL, first - 1);
+            composite_frame(&w->view, &w->config);
+            w->config.stats = stats;
+        }
+    }
+
+    for (int frame = first; frame < first + OFFLINE_CHUNK && frame < MAX_FRAMES; frame++) {
+        int active_chars = advance_effect(&w->view, &w->config, job->func, NULL, frame);
+        if (composite_frame(&w->view, &w->config)) {
+            capture_frame(&w->view, &w->slot);
+            job->format(&w->slot, &w->config, &w->out);
+            w->frames[w->count] = frame;
+            w->ends[w->count] = w->out.len;
+            w->count++;
+        }
+        w->last_frame = frame;
+        if (animation_finished(active_chars, frame)) {
+            w->finished = 1;
+            break;
+        }
+    }
+}
+
+// Render the whole animation from first_frame without pacing. The frame
+// range is cut into OFFLINE_CHUNK-frame chunks that the pool's workers
+// render side by side, each on its own terminal; frames reach output in
+// order and byte for byte as the live loop would emit them. Frames are
+// encoded by format, format_ansi_frame if NULL. Returns -1 if the workers
+// could not be set up.
+int render_offline(terminal_t *term, config_t *config, effect_func_t func, worker_pool_t *pool,
+                   int first_frame, frame_format_t format, frame_output_t output, void *ctx) {
+    int count = pool ? pool->count : 1;
+    offline_worker_t *workers = calloc(count, sizeof(offline_worker_t));
+    if (!workers || !term->initial) {
+        free(workers);
+        return -1;
+    }
+
+    int ready = 1;
+    for (int w = 0; w < count; w++) {
+        ready &= init_view(&workers[w].view, term);
+        workers[w].last_frame = -2;
+        workers[w].config = *config;
+        if (config->stats) {
+            stats_init(&workers[w].stats);
+            workers[w].config.stats = &workers[w].stats;
+        }
+    }
+
+    int done = 0;
+    offline_job_t job = {workers, config, func, format ? format : format_ansi_frame, 0, first_frame};
+    while (ready && !done) {
+        if (pool) {
+            worker_pool_run(pool, render_chunk, &job);
+        } else {
+            render_chunk(&job, 0);
+        }
+
+        // Hand over finished chunks in frame order up to the last frame;
+        // chunks past it are dropped, their measurements with them
+        for (int w = 0; w < count; w++) {
+            offline_worker_t *worker = &workers[w];
+            if (config->stats && done) {
+                stats_clear(&worker->stats);
+            } else if (config->stats) {
+                stats_merge(config->stats, &worker->stats);
+            }
+            if (done) {
+                continue;
+            }
+            size_t start = 0;
+            for (int k = 0; k < worker->count; k++) {
+                double begin = stats_start(config);
+                output(ctx, worker->frames[k], worker->out.data + start, worker->ends[k] - start);
+                if (config->stats) {
+                    stats_stop(config, STAT_WRITE, begin);
+                    stats_add(config->stats, STAT_BYTES, (double)(worker->ends[k] - start));
+                }
+                start = worker->ends[k];
+            }
+            done = worker->finished;
+        }
+        job.first_chunk += count;
+    }
+
+    for (int w = 0; w < count; w++) {
+        cleanup_terminal(&workers[w].view);
+        free_frame_slot(&workers[w].slot);
+        buffer_free(&workers[w].out);
+        if (config->stats) {
+            stats_free(&workers[w].stats);
+        }
+    }
+    free(workers);
+    return ready ? 0 : -1;
+}
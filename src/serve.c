@@ -0,0 +1,353 @@
+#include "tte.h"
+#ifdef __GLIBC__
+#include <malloc.h>
+#endif
+
+// Animation daemon (--serve) and its client (--connect). A client sends one
+// request: a header, its terminal's file descriptor as SCM_RIGHTS ancillary
+// data, its options as NUL-terminated strings and the raw input text. The
+// daemon draws the animation straight onto that descriptor on a thread of
+// its own and answers with one status byte once the last frame is out, so
+// the client costs a socket round trip instead of a full start-up. The
+// socket is created mode 0600; only its owner can connect.
+
+typedef struct {
+    uint32_t magic;
+    uint32_t argc;            // Strings in the options block
+    uint32_t args_len;        // Bytes of options, NUL terminators included
+    uint32_t input_len;       // Bytes of input text after the options
+} serve_header_t;
+
+// Statuses besides the animation's own 0 and 1
+#define SERVE_REJECTED 2      // Malformed request or an option the daemon does not run
+
+static int send_all(int sock, const char *data, size_t len) {
+    while (len > 0) {
+        ssize_t sent = send(sock, data, len, MSG_NOSIGNAL);
+        if (sent < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return -1;
+        }
+        data += sent;
+        len -= sent;
+    }
+    return 0;
+}
+
+static int recv_all(int sock, char *data, size_t len) {
+    while (len > 0) {
+        ssize_t got = recv(sock, data, len, 0);
+        if (got < 0 && errno == EINTR) {
+            continue;
+        }
+        if (got <= 0) {
+            return -1;
+        }
+        data += got;
+        len -= got;
+    }
+    return 0;
+}
+
+// Draw one animation on fd the way a local run would on its terminal.
+// Returns the exit status for the client.
+int serve_animation(config_t *config, const byte_buffer_t *input, int fd) {
+    const effect_info_t *effect = config->effect_name ? find_effect(config->effect_name) : NULL;
+    if (!effect) {
+        return 1;
+    }
+    resolve_gradient(config);
+
+    terminal_t term = {0};
+    int width, height;
+    get_fd_size(fd, &width, &height);
+    if (layout_input(&term, config, input, width, height) != 0) {
+        cleanup_terminal(&term);
+        return 1;
+    }
+
+    worker_pool_t *pool = NULL;
+    if (config->threads > 1) {
+        pool = worker_pool_create(config->threads);
+        term.pool = pool;
+    }
+    output_t out;
+    output_init_tty(&out, fd);
+    output_write(&out, ANSI_HIDE_CURSOR, sizeof(ANSI_HIDE_CURSOR) - 1);
+    show_animation(&term, config, effect, pool, input, &out);
+    output_write(&out, ANSI_SHOW_CURSOR, sizeof(ANSI_SHOW_CURSOR) - 1);
+    if (!config->no_final_newline) {
+        output_write(&out, "\n", 1);
+    }
+    output_close(&out);
+
+    term.pool = NULL;
+    worker_pool_destroy(pool);
+    cleanup_terminal(&term);
+    return 0;
+}
+
+// Whether the client that asked for this animation has gone away (closed
+// or killed), so the rest of it should not be drawn on its terminal.
+// Never blocks; anything but a socket at its end is never hung up.
+int serve_hung_up(const config_t *config) {
+    if (config->hangup_fd < 0) {
+        return 0;
+    }
+    struct pollfd watch = {config->hangup_fd, POLLIN, 0};
+    if (poll(&watch, 1, 0) <= 0) {
+        return 0;
+    }
+    // Clients send nothing after the request, so readable means end of
+    // file, or a reset connection
+    char byte;
+    ssize_t got = recv(config->hangup_fd, &byte, 1, MSG_PEEK | MSG_DONTWAIT);
+    return got == 0 || (got < 0 && (errno == ECONNRESET || errno == EPIPE));
+}
+
+// Read a request and the descriptor passed with it. Returns -1 if the
+// request is malformed; fd is -1 unless one arrived.
+static int receive_request(int conn, serve_header_t *header, int *fd, char **args, byte_buffer_t *input) {
+    union {
+        struct cmsghdr header;
+        char space[CMSG_SPACE(sizeof(int))];
+    } control;
+    struct iovec iov = {header, sizeof(*header)};
+    struct msghdr msg = {0};
+    msg.msg_iov = &iov;
+    msg.msg_iovlen = 1;
+    msg.msg_control = control.space;
+    msg.msg_controllen = sizeof(control.space);
+
+    *fd = -1;
+    ssize_t got;
+    do {
+        got = recvmsg(conn, &msg, 0);
+    } while (got < 0 && errno == EINTR);
+    struct cmsghdr *cmsg = got > 0 ? CMSG_FIRSTHDR(&msg) : NULL;
+    if (cmsg && cmsg->cmsg_level == SOL_SOCKET && cmsg->cmsg_type == SCM_RIGHTS &&
+        cmsg->cmsg_len == CMSG_LEN(sizeof(int))) {
+        memcpy(fd, CMSG_DATA(cmsg), sizeof(int));
+    }
+    if (got <= 0 || *fd < 0 || (msg.msg_flags & MSG_CTRUNC)) {
+        return -1;
+    }
+    if ((size_t)got < sizeof(*header) &&
+        recv_all(conn, (char *)header + got, sizeof(*header) - got) != 0) {
+        return -1;
+    }
+    if (header->magic != SERVE_MAGIC || header->argc > SERVE_MAX_ARGS || header->args_len == 0 ||
+        header->args_len > SERVE_MAX_ARGS_LEN || header->input_len > SERVE_MAX_INPUT) {
+        return -1;
+    }
+
+    *args = malloc(header->args_len);
+    if (!*args || recv_all(conn, *args, header->args_len) != 0 || (*args)[header->args_len - 1] != '\0') {
+        return -1;
+    }
+    char chunk[65536];
+    for (size_t left = header->input_len; left > 0; ) {
+        size_t n = left < sizeof(chunk) ? left : sizeof(chunk);
+        if (recv_all(conn, chunk, n) != 0) {
+            return -1;
+        }
+        buffer_append(input, chunk, n);
+        left -= n;
+    }
+    return 0;
+}
+
+// Run one client's request and answer with its status
+void serve_client(int conn) {
+    serve_header_t header;
+    int fd;
+    char *args = NULL;
+    byte_buffer_t input = {0};
+    unsigned char status = SERVE_REJECTED;
+
+    if (receive_request(conn, &header, &fd, &args, &input) == 0) {
+        // Split the options back into an argv for parse_args
+        char *argv[SERVE_MAX_ARGS + 1];
+        int argc = 1;
+        argv[0] = "tte-c";
+        int rejected = 0;
+        for (size_t at = 0; at < header.args_len && argc <= SERVE_MAX_ARGS; argc++) {
+            argv[argc] = args + at;
+            // --help would exit the daemon; clients handle it themselves
+            rejected |= strcmp(argv[argc], "-h") == 0 || strcmp(argv[argc], "--help") == 0;
+            at += strlen(args + at) + 1;
+        }
+        config_t config;
+        init_config(&config);
+        if (!rejected && (uint32_t)(argc - 1) == header.argc) {
+            rejected = parse_args(argc, argv, &config) != 0;
+            // Files named by the client are its own to write
+            rejected |= config.record_path || config.save_path || config.bake_path || config.play_path ||
+                        config.serve_path || config.sink || config.output_count || config.batch_path;
+            if (!rejected) {
+                config.hangup_fd = conn;
+                status = (unsigned char)serve_animation(&config, &input, fd);
+            }
+        }
+    }
+    if (fd >= 0) {
+        close(fd);
+    }
+    send_all(conn, (const char *)&status, 1);
+    close(conn);
+    free(args);
+    buffer_free(&input);
+}
+
+// Listen on path, replacing a stale socket left by a daemon that died.
+// Fails with EADDRINUSE if a daemon is still answering there.
+int serve_listen(const char *path) {
+    struct sockaddr_un addr = {0};
+    addr.sun_family = AF_UNIX;
+    if (strlen(path) >= sizeof(addr.sun_path)) {
+        errno = ENAMETOOLONG;
+        return -1;
+    }
+    strcpy(addr.sun_path, path);
+
+    int sock = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (sock < 0) {
+        return -1;
+    }
+    struct stat st;
+    if (lstat(path, &st) == 0 && S_ISSOCK(st.st_mode)) {
+        if (connect(sock, (struct sockaddr *)&addr, sizeof(addr)) == 0) {
+            close(sock);
+            errno = EADDRINUSE;
+            return -1;
+        }
+        unlink(path);
+    }
+
+    mode_t mask = umask(0177);
+    int bound = bind(sock, (struct sockaddr *)&addr, sizeof(addr));
+    umask(mask);
+    if (bound != 0 || listen(sock, SOMAXCONN) != 0) {
+        int saved = errno;
+        close(sock);
+        errno = saved;
+        return -1;
+    }
+    return sock;
+}
+
+static void *client_main(void *arg) {
+    serve_client((int)(intptr_t)arg);
+    return NULL;
+}
+
+// Serve clients on path, each on its own thread, until the process is
+// killed. Returns -1 if the socket cannot be set up.
+int serve(const char *path) {
+    int sock = serve_listen(path);
+    if (sock < 0) {
+        return -1;
+    }
+    // A client's terminal going away must not take the daemon with it
+    signal(SIGPIPE, SIG_IGN);
+#ifdef M_MMAP_THRESHOLD
+    // A terminal is tens of megabytes of mostly untouched zeroes. Fixing
+    // the threshold keeps those as fresh mappings the kernel zeroes lazily;
+    // glibc would otherwise move them into the client threads' arenas,
+    // where every calloc clears all of it
+    mallopt(M_MMAP_THRESHOLD, 256 * 1024);
+#endif
+
+    pthread_attr_t attr;
+    pthread_attr_init(&attr);
+    pthread_attr_setdetachstate(&attr, PTHREAD_CREATE_DETACHED);
+    for (;;) {
+        int conn = accept(sock, NULL, NULL);
+        if (conn < 0) {
+            if (errno == EINTR || errno == ECONNABORTED) {
+                continue;
+            }
+            if (errno == EMFILE || errno == ENFILE || errno == ENOMEM || errno == ENOBUFS) {
+                sleep_frame(10);  // Out of resources; let running clients finish
+                continue;
+            }
+            break;
+        }
+        pthread_t thread;
+        if (pthread_create(&thread, &attr, client_main, (void *)(intptr_t)conn) != 0) {
+            serve_client(conn);
+        }
+    }
+    pthread_attr_destroy(&attr);
+    close(sock);
+    return -1;
+}
+
+// Hand the animation to the daemon on path, to be drawn on fd. argv is the
+// client's own command line; --connect is not passed on. Returns -1 if no
+// daemon took the request, in which case the caller draws it itself.
+int serve_connect(const char *path, int argc, char *argv[], const byte_buffer_t *input, int fd, int *status) {
+    struct sockaddr_un addr = {0};
+    addr.sun_family = AF_UNIX;
+    if (strlen(path) >= sizeof(addr.sun_path) || input->len > SERVE_MAX_INPUT) {
+        return -1;
+    }
+    strcpy(addr.sun_path, path);
+
+    byte_buffer_t args = {0};
+    serve_header_t header = {SERVE_MAGIC, 0, 0, (uint32_t)input->len};
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--connect") == 0) {
+            i++;
+            continue;
+        }
+        buffer_append(&args, argv[i], strlen(argv[i]) + 1);
+        header.argc++;
+    }
+    header.args_len = (uint32_t)args.len;
+    if (header.argc > SERVE_MAX_ARGS || args.len == 0 || args.len > SERVE_MAX_ARGS_LEN) {
+        buffer_free(&args);
+        return -1;
+    }
+
+    int sock = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (sock < 0) {
+        buffer_free(&args);
+        return -1;
+    }
+    union {
+        struct cmsghdr header;
+        char space[CMSG_SPACE(sizeof(int))];
+    } control;
+    memset(&control, 0, sizeof(control));
+    struct iovec iov = {&header, sizeof(header)};
+    struct msghdr msg = {0};
+    msg.msg_iov = &iov;
+    msg.msg_iovlen = 1;
+    msg.msg_control = control.space;
+    msg.msg_controllen = sizeof(control.space);
+    struct cmsghdr *cmsg = CMSG_FIRSTHDR(&msg);
+    cmsg->cmsg_level = SOL_SOCKET;
+    cmsg->cmsg_type = SCM_RIGHTS;
+    cmsg->cmsg_len = CMSG_LEN(sizeof(int));
+    memcpy(CMSG_DATA(cmsg), &fd, sizeof(int));
+
+    // Until the whole request is out the daemon has drawn nothing, so any
+    // failure up to here can still fall back to a local run
+    int sent = connect(sock, (struct sockaddr *)&addr, sizeof(addr)) == 0 &&
+               sendmsg(sock, &msg, MSG_NOSIGNAL) == (ssize_t)sizeof(header) &&
+               send_all(sock, args.data, args.len) == 0 &&
+               send_all(sock, input->data, input->len) == 0;
+    buffer_free(&args);
+    if (!sent) {
+        close(sock);
+        return -1;
+    }
+
+    unsigned char answer;
+    *status = recv_all(sock, (char *)&answer, 1) == 0 ? answer : 1;
+    close(sock);
+    return 0;
+}
@@ -0,0 +1,113 @@
+#include "tte.h"
+
+// --shm: publish every composited frame as packed cells in a POSIX
+// shared-memory ring (layout in tte_shm.h) for status bars, tmux and other
+// compositors that want cells rather than escape sequences.
+
+// Create name (a leading '/' is added if missing) sized for rows x cols
+int shm_export_open(shm_export_t *shm, const char *name, int rows, int cols, int frame_rate) {
+    memset(shm, 0, sizeof(*shm));
+    int n = snprintf(shm->name, sizeof(shm->name), "%s%s", name[0] == '/' ? "" : "/", name);
+    if (n < 0 || (size_t)n >= sizeof(shm->name)) {
+        errno = ENAMETOOLONG;
+        return -1;
+    }
+    size_t slot_size = sizeof(tte_shm_slot_t) + (size_t)rows * cols * sizeof(tte_shm_cell_t);
+    shm->size = sizeof(tte_shm_header_t) + TTE_SHM_SLOTS * slot_size;
+
+    int fd = shm_open(shm->name, O_RDWR | O_CREAT | O_TRUNC, 0600);
+    if (fd < 0) {
+        return -1;
+    }
+    void *map = MAP_FAILED;
+    if (ftruncate(fd, (off_t)shm->size) == 0) {
+        map = mmap(NULL, shm->size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    }
+    int saved = errno;
+    close(fd);
+    if (map == MAP_FAILED) {
+        shm_unlink(shm->name);
+        errno = saved;
+        return -1;
+    }
+
+    // The object is zero-filled, so every slot starts even and empty
+    shm->header = map;
+    shm->rows = rows;
+    shm->cols = cols;
+    shm->header->version = TTE_SHM_VERSION;
+    shm->header->rows = rows;
+    shm->header->cols = cols;
+    shm->header->slots = TTE_SHM_SLOTS;
+    shm->header->slot_size = (uint32_t)slot_size;
+    shm->header->frame_rate = frame_rate;
+    // Readers check the magic last of all
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+    memcpy(shm->header->magic, TTE_SHM_MAGIC, 4);
+    return 0;
+}
+
+// Copy the composited screen into the next slot and publish it
+void shm_export_frame(shm_export_t *shm, const framebuffer_t *fb, int frame) {
+    tte_shm_header_t *header = shm->header;
+    uint64_t index = header->published;
+    tte_shm_slot_t *slot = tte_shm_slot(header, index);
+    uint64_t seq = slot->seq;
+
+    __atomic_store_n(&slot->seq, seq + 1, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+    slot->frame = (uint32_t)frame;
+    tte_shm_cell_t *cell = tte_shm_cells(slot);
+    for (int row = 0; row < shm->rows; row++) {
+        for (int col = 0; col < shm->cols; col++, cell++) {
+            int fg = fb->screen_fg[row][col];
+            int bg = fb->screen_bg[row][col];
+            cell->glyph = (unsigned char)fb->screen[row][col];
+            cell->fg = fg >= 0 ? (uint8_t)fg : 0;
+            cell->bg = bg >= 0 ? (uint8_t)bg : 0;
+            cell->attrs = (fb->screen_bold[row][col] ? TTE_SHM_BOLD : 0) | (fg >= 0 ? TTE_SHM_FG : 0) |
+                          (bg >= 0 ? TTE_SHM_BG : 0);
+        }
+    }
+    __atomic_store_n(&slot->seq, seq + 2, __ATOMIC_RELEASE);
+    __atomic_store_n(&header->published, index + 1, __ATOMIC_RELEASE);
+}
+
+// Mark the animation finished and remove the name; readers that have it
+// mapped keep the last frame
+void shm_export_close(shm_export_t *shm) {
+    if (!shm->header) {
+        return;
+    }
+    __atomic_or_fetch(&shm->header->flags, TTE_SHM_DONE, __ATOMIC_RELEASE);
+    munmap(shm->header, shm->size);
+    shm_unlink(shm->name);
+    shm->header = NULL;
+}
+
+// Run the animation at its frame rate with the ring as its only output
+int shm_animate(terminal_t *term, config_t *config, const effect_info_t *effect, worker_pool_t *pool) {
+    shm_export_t shm;
+    int rows = term->terminal_height < MAX_LINES ? term->terminal_height : MAX_LINES;
+    int cols = term->terminal_width < MAX_COLS ? term->terminal_width : MAX_COLS;
+    if (shm_export_open(&shm, config->shm_name, rows, cols, config->frame_rate) != 0) {
+        return -1;
+    }
+    int parallel = pool && (effect->flags & EFFECT_PARALLEL);
+    struct timespec epoch;
+    clock_gettime(CLOCK_MONOTONIC, &epoch);
+    for (int frame = config->start_frame; ; frame++) {
+        int active_chars = advance_effect(term, config, effect->func, parallel ? pool : NULL, frame);
+        if (composite_frame(term, config)) {
+            shm_export_frame(&shm, term->fb, frame);
+        }
+        if (animation_finished(active_chars, frame)) {
+            break;
+        }
+        if (sleep_until_frame(&epoch, frame - config->start_frame + 1, config->frame_rate)) {
+            stats_missed(config);
+        }
+    }
+    shm_export_close(&shm);
+    return 0;
+}
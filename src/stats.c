@@ -0,0 +1,184 @@
+#include "tte.h"
+
+// --stats: every stage of every frame is timed and every frame's output
+// counted, and the distributions are reported when the run ends. Stages
+// record from the effect, encoder and writer threads, so the collector is
+// locked; without --stats config->stats is NULL and nothing is recorded.
+
+static const struct {
+    const char *name;
+    int timing;               // Seconds, reported in milliseconds
+} stat_names[STAT_SERIES] = {
+    {"effect", 1},
+    {"gradient", 1},
+    {"background", 1},
+    {"composite", 1},
+    {"encode", 1},
+    {"write", 1},
+    {"bytes", 0},
+    {"sgr", 0},
+    {"cells", 0},
+};
+
+void stats_init(stats_t *stats) {
+    memset(stats, 0, sizeof(*stats));
+    pthread_mutex_init(&stats->lock, NULL);
+}
+
+void stats_free(stats_t *stats) {
+    for (int i = 0; i < STAT_SERIES; i++) {
+        free(stats->series[i].samples);
+    }
+    pthread_mutex_destroy(&stats->lock);
+    memset(stats, 0, sizeof(*stats));
+}
+
+void stats_add(stats_t *stats, int series, double value) {
+    pthread_mutex_lock(&stats->lock);
+    stat_series_t *s = &stats->series[series];
+    if (s->count == s->capacity) {
+        size_t capacity = s->capacity ? s->capacity * 2 : 1024;
+        double *samples = realloc(s->samples, capacity * sizeof(double));
+        if (!samples) {
+            pthread_mutex_unlock(&stats->lock);
+            return;  // Drop the sample rather than the frame
+        }
+        s->samples = samples;
+        s->capacity = capacity;
+    }
+    s->samples[s->count++] = value;
+    pthread_mutex_unlock(&stats->lock);
+}
+
+// Move every sample of from into stats, leaving from empty
+void stats_merge(stats_t *stats, stats_t *from) {
+    pthread_mutex_lock(&from->lock);
+    for (int i = 0; i < STAT_SERIES; i++) {
+        for (size_t k = 0; k < from->series[i].count; k++) {
+            stats_add(stats, i, from->series[i].samples[k]);
+        }
+    }
+    __atomic_add_fetch(&stats->missed, from->missed, __ATOMIC_RELAXED);
+    pthread_mutex_unlock(&from->lock);
+    stats_clear(from);
+}
+
+// Drop every sample, keeping the memory for the next ones
+void stats_clear(stats_t *stats) {
+    pthread_mutex_lock(&stats->lock);
+    for (int i = 0; i < STAT_SERIES; i++) {
+        stats->series[i].count = 0;
+    }
+    stats->missed = 0;
+    pthread_mutex_unlock(&stats->lock);
+}
+
+// Start timing a stage: the current time, or 0 when nothing is collected
+double stats_start(const config_t *config) {
+    if (!config || !config->stats) {
+        return 0;
+    }
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return now.tv_sec + now.tv_nsec / 1e9;
+}
+
+// Record the time since start as one sample of series
+void stats_stop(const config_t *config, int series, double start) {
+    if (!config || !config->stats) {
+        return;
+    }
+    stats_add(config->stats, series, stats_start(config) - start);
+}
+
+// Record a frame written after its deadline
+void stats_missed(const config_t *config) {
+    if (config && config->stats) {
+        __atomic_add_fetch(&config->stats->missed, 1, __ATOMIC_RELAXED);
+    }
+}
+
+// Record the counts of one encoded frame: cells captured and SGR sequences
+void stats_encoded(const config_t *config, const frame_slot_t *slot) {
+    if (!config || !config->stats) {
+        return;
+    }
+    int sgr = 0;
+    for (int b = 0; b <= slot->band_count; b++) {
+        const byte_buffer_t *band = b < slot->band_count ? &slot->bands[b] : &slot->trailer;
+        for (size_t i = 0; i + 1 < band->len; i++) {
+            if (band->data[i] != '\033' || band->data[i + 1] != '[') {
+                continue;
+            }
+            size_t end = i + 2;
+            while (end < band->len && ((band->data[end] >= '0' && band->data[end] <= '9') || band->data[end] == ';')) {
+                end++;
+            }
+            sgr += end < band->len && band->data[end] == 'm';
+            i = end;
+        }
+    }
+    stats_add(config->stats, STAT_SGR, sgr);
+    stats_add(config->stats, STAT_CELLS, slot->cell_count);
+}
+
+static int compare_samples(const void *a, const void *b) {
+    double x = *(const double *)a, y = *(const double *)b;
+    return (x > y) - (x < y);
+}
+
+// Min, median, p99 and max of a series; sorts its samples
+static void summarize(stat_series_t *s, double out[4]) {
+    memset(out, 0, 4 * sizeof(double));
+    if (!s->count) {
+        return;
+    }
+    qsort(s->samples, s->count, sizeof(double), compare_samples);
+    size_t p99 = (size_t)ceil(s->count * 0.99) - 1;
+    out[0] = s->samples[0];
+    out[1] = s->samples[s->count / 2];
+    out[2] = s->samples[p99 < s->count ? p99 : s->count - 1];
+    out[3] = s->samples[s->count - 1];
+}
+
+// Write the distributions to config->stats_path, or stderr, as a table or
+// with --stats=json as one JSON object. Returns -1 if the file cannot be
+// written.
+int stats_report(stats_t *stats, const config_t *config) {
+    FILE *out = config->stats_path ? fopen(config->stats_path, "w") : stderr;
+    if (!out) {
+        return -1;
+    }
+    int json = config->stats_format == STATS_JSON;
+    unsigned long frames = stats->series[STAT_EFFECT].count;
+    if (json) {
+        fprintf(out, "{\"frames\": %lu, \"missed_deadlines\": %lu", frames, stats->missed);
+    } else {
+        fprintf(out, "%lu frames, %lu missed deadlines\n", frames, stats->missed);
+        fprintf(out, "%-11s %7s %11s %11s %11s %11s\n", "stage", "samples", "min", "median", "p99", "max");
+    }
+    for (int i = 0; i < STAT_SERIES; i++) {
+        stat_series_t *s = &stats->series[i];
+        double values[4];
+        summarize(s, values);
+        double scale = stat_names[i].timing ? 1000.0 : 1.0;
+        if (json) {
+            fprintf(out, ", \"%s%s\": {\"samples\": %zu, \"min\": %.6g, \"median\": %.6g, \"p99\": %.6g, \"max\": %.6g}",
+                    stat_names[i].name, stat_names[i].timing ? "_ms" : "", s->count, values[0] * scale,
+                    values[1] * scale, values[2] * scale, values[3] * scale);
+        } else if (stat_names[i].timing) {
+            fprintf(out, "%-11s %7zu %9.3fms %9.3fms %9.3fms %9.3fms\n", stat_names[i].name, s->count,
+                    values[0] * scale, values[1] * scale, values[2] * scale, values[3] * scale);
+        } else {
+            fprintf(out, "%-11s %7zu %11.0f %11.0f %11.0f %11.0f\n", stat_names[i].name, s->count,
+                    values[0], values[1], values[2], values[3]);
+        }
+    }
+    if (json) {
+        fprintf(out, "}\n");
+    }
+    if (out != stderr) {
+        return fclose(out) == 0 ? 0 : -1;
+    }
+    return 0;
+}
@@ -0,0 +1,256 @@
+#include "tte.h"
+
+#define SWEEP_WORD_BITS 64
+
+void free_sweep_mask(terminal_t *term) {
+    sweep_mask_t *mask = term->sweep;
+    if (mask) {
+        free(mask->reveal);
+        free(mask->highlight);
+        free(mask->distance);
+        free(mask);
+        term->sweep = NULL;
+    }
+}
+
+// Size the grid to cover every character, including wrapped lines that
+// reach past the measured text width
+static sweep_mask_t *build_sweep_mask(terminal_t *term) {
+    free_sweep_mask(term);
+
+    int width = term->text_width > 0 ? term->text_width : 1;
+    int height = term->text_height > 0 ? term->text_height : 1;
+    for (int i = 0; i < term->char_count; i++) {
+        if (term->chars[i].target.col >= width) width = term->chars[i].target.col + 1;
+        if (term->chars[i].target.row >= height) height = term->chars[i].target.row + 1;
+    }
+
+    sweep_mask_t *mask = calloc(1, sizeof(sweep_mask_t));
+    if (!mask) {
+        return NULL;
+    }
+    mask->width = width;
+    mask->height = height;
+    mask->words = (width + SWEEP_WORD_BITS - 1) / SWEEP_WORD_BITS;
+    mask->reveal = malloc((size_t)mask->words * height * sizeof(uint64_t));
+    mask->highlight = malloc((size_t)mask->words * height * sizeof(uint64_t));
+    mask->distance = malloc((size_t)mask->words * SWEEP_WORD_BITS * height * sizeof(float));
+    mask->center_row = -1;
+    mask->center_col = -1;
+    mask->char_count = term->char_count;
+    mask->text_width = term->text_width;
+    mask->text_height = term->text_height;
+    term->sweep = mask;
+    if (!mask->reveal || !mask->highlight || !mask->distance) {
+        free_sweep_mask(term);
+        return NULL;
+    }
+    return mask;
+}
+
+// Start a frame with empty masks
+sweep_mask_t *sweep_begin(terminal_t *term) {
+    sweep_mask_t *mask = term->sweep;
+    if (!mask || mask->char_count != term->char_count ||
+        mask->text_width != term->text_width || mask->text_height != term->text_height) {
+        mask = build_sweep_mask(term);
+        if (!mask) {
+            return NULL;
+        }
+    }
+    size_t bytes = (size_t)mask->words * mask->height * sizeof(uint64_t);
+    memset(mask->reveal, 0, bytes);
+    memset(mask->highlight, 0, bytes);
+    return mask;
+}
+
+// Set bits for columns first..last of one row
+static void set_span(const sweep_mask_t *mask, uint64_t *row_bits, long first, long last) {
+    if (first < 0) first = 0;
+    if (last > mask->width - 1) last = mask->width - 1;
+    if (first > last) {
+        return;
+    }
+
+    int first_word = (int)(first / SWEEP_WORD_BITS);
+    int last_word = (int)(last / SWEEP_WORD_BITS);
+    uint64_t head = ~0ULL << (first % SWEEP_WORD_BITS);
+    uint64_t tail = ~0ULL >> (SWEEP_WORD_BITS - 1 - last % SWEEP_WORD_BITS);
+
+    if (first_word == last_word) {
+        row_bits[first_word] |= head & tail;
+        return;
+    }
+    row_bits[first_word] |= head;
+    for (int w = first_word + 1; w < last_word; w++) {
+        row_bits[w] = ~0ULL;
+    }
+    row_bits[last_word] |= tail;
+}
+
+// Clamp a band edge far enough outside the grid that shifting it by a row
+// for the diagonals still lands outside
+static long clamp_edge(float value, int limit) {
+    if (value < -(float)limit - 1.0f) return -(long)limit - 1;
+    if (value > (float)limit + 1.0f) return limit + 1;
+    return (long)value;
+}
+
+// A straight band [pos - half_width, pos + half_width] along the axis.
+// Cells behind the band (u < pos - half_width) count as revealed. For the
+// row and column axes the band only spans cross_lo..cross_hi across it.
+void sweep_band(sweep_mask_t *mask, sweep_axis_t axis, float pos, float half_width,
+                int cross_lo, int cross_hi) {
+    if (!mask) {
+        return;
+    }
+
+    // Integer coordinates inside the band; everything below lo has passed
+    int span = mask->width + mask->height;
+    long lo = clamp_edge(ceilf(pos - half_width), span);
+    long hi = clamp_edge(floorf(pos + half_width), span);
+
+    for (int row = 0; row < mask->height; row++) {
+        uint64_t *reveal = mask->reveal + (size_t)row * mask->words;
+        uint64_t *highlight = mask->highlight + (size_t)row * mask->words;
+
+        switch (axis) {
+            case SWEEP_COLS:
+                if (row < cross_lo || row > cross_hi) {
+                    break;
+                }
+                set_span(mask, reveal, 0, hi);
+                set_span(mask, highlight, lo, hi);
+                break;
+
+            case SWEEP_ROWS:
+                if (row <= hi) {
+                    set_span(mask, reveal, cross_lo, cross_hi);
+                    if (row >= lo) {
+                        set_span(mask, highlight, cross_lo, cross_hi);
+                    }
+                }
+                break;
+
+            case SWEEP_DIAG_DOWN:
+                set_span(mask, reveal, 0, hi + row);
+                set_span(mask, highlight, lo + row, hi + row);
+                break;
+
+            case SWEEP_DIAG_UP:
+                set_span(mask, reveal, 0, hi - row);
+                set_span(mask, highlight, lo - row, hi - row);
+                break;
+        }
+    }
+}
+
+// Distance of every cell from the center, recomputed only when it moves
+static void prepare_distances(sweep_mask_t *mask, int center_row, int center_col) {
+    if (mask->center_row == center_row && mask->center_col == center_col) {
+        return;
+    }
+    int stride = mask->words * SWEEP_WORD_BITS;
+    for (int row = 0; row < mask->height; row++) {
+        float *dist = mask->distance + (size_t)row * stride;
+        int dy = row - center_row;
+        for (int col = 0; col < stride; col++) {
+            int dx = col - center_col;
+            dist[col] = sqrt(dx * dx + dy * dy);
+        }
+    }
+    mask->center_row = center_row;
+    mask->center_col = center_col;
+}
+
+// Bits past the grid width are cleared so they never read as covered
+static uint64_t width_mask(const sweep_mask_t *mask, int word) {
+    int remaining = mask->width - word * SWEEP_WORD_BITS;
+    return remaining >= SWEEP_WORD_BITS ? ~0ULL : ((1ULL << remaining) - 1);
+}
+
+// An expanding ring: cells within half_width of the radius are covered,
+// cells inside the ring have been passed
+void sweep_ring(sweep_mask_t *mask, int center_row, int center_col, float radius, float half_width) {
+    if (!mask) {
+        return;
+    }
+    prepare_distances(mask, center_row, center_col);
+
+    int stride = mask->words * SWEEP_WORD_BITS;
+    for (int row = 0; row < mask->height; row++) {
+        const float *dist = mask->distance + (size_t)row * stride;
+        for (int w = 0; w < mask->words; w++) {
+            const float *d = dist + w * SWEEP_WORD_BITS;
+            uint64_t covered = 0;
+            uint64_t passed = 0;
+            for (int b = 0; b < SWEEP_WORD_BITS; b++) {
+                covered |= (uint64_t)(radius >= d[b] - half_width && radius <= d[b] + half_width) << b;
+                passed |= (uint64_t)(radius > d[b] + half_width) << b;
+            }
+            uint64_t valid = width_mask(mask, w);
+            mask->reveal[(size_t)row * mask->words + w] |= (covered | passed) & valid;
+            mask->highlight[(size_t)row * mask->words + w] |= covered & valid;
+        }
+    }
+}
+
+// A filled circle: every cell within the radius is covered
+void sweep_circle(sweep_mask_t *mask, int center_row, int center_col, float radius) {
+    if (!mask) {
+        return;
+    }
+    prepare_distances(mask, center_row, center_col);
+
+    int stride = mask->words * SWEEP_WORD_BITS;
+    for (int row = 0; row < mask->height; row++) {
+        const float *dist = mask->distance + (size_t)row * stride;
+        for (int w = 0; w < mask->words; w++) {
+            const float *d = dist + w * SWEEP_WORD_BITS;
+            uint64_t covered = 0;
+            for (int b = 0; b < SWEEP_WORD_BITS; b++) {
+                covered |= (uint64_t)(d[b] <= radius) << b;
+            }
+            covered &= width_mask(mask, w);
+            mask->reveal[(size_t)row * mask->words + w] |= covered;
+            mask->highlight[(size_t)row * mask->words + w] |= covered;
+        }
+    }
+}
+
+// A filled disc of integer radius that has been passed over: cells within
+// it count as revealed only. Stamps just the rows and spans it covers.
+void sweep_disc(sweep_mask_t *mask, int center_row, int center_col, int radius) {
+    if (!mask) {
+        return;
+    }
+    for (int dy = -radius; dy <= radius; dy++) {
+        int row = center_row + dy;
+        if (row < 0 || row >= mask->height) {
+            continue;
+        }
+        // Widest dx with dx * dx + dy * dy <= radius * radius
+        int span = 0;
+        while ((span + 1) * (span + 1) + dy * dy <= radius * radius) {
+            span++;
+        }
+        set_span(mask, mask->reveal + (size_t)row * mask->words,
+                 (long)center_col - span, (long)center_col + span);
+    }
+}
+
+static int sweep_bit(const sweep_mask_t *mask, const uint64_t *bits, int row, int col) {
+    if (!mask || row < 0 || row >= mask->height || col < 0 || col >= mask->width) {
+        return 0;
+    }
+    uint64_t word = bits[(size_t)row * mask->words + col / SWEEP_WORD_BITS];
+    return (int)((word >> (col % SWEEP_WORD_BITS)) & 1);
+}
+
+int sweep_revealed(const sweep_mask_t *mask, int row, int col) {
+    return mask ? sweep_bit(mask, mask->reveal, row, col) : 0;
+}
+
+int sweep_highlighted(const sweep_mask_t *mask, int row, int col) {
+    return mask ? sweep_bit(mask, mask->highlight, row, col) : 0;
+}
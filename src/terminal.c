@@ -1,8 +1,9 @@
 #include "tte.h"
 
-void get_terminal_size(int *width, int *height) {
+// Size of the terminal on fd, or 80x24 if it is not one
+void get_fd_size(int fd, int *width, int *height) {
     struct winsize w;
-    if (ioctl(STDOUT_FILENO, TIOCGWINSZ, &w) == 0) {
+    if (ioctl(fd, TIOCGWINSZ, &w) == 0) {
         *width = w.ws_col;
         *height = w.ws_row;
     } else {
@@ -11,6 +12,10 @@ void get_terminal_size(int *width, int *height) {
     }
 }
 
+void get_terminal_size(int *width, int *height) {
+    get_fd_size(STDOUT_FILENO, width, height);
+}
+
 void init_terminal(terminal_t *term) {
     get_terminal_size(&term->terminal_width, &term->terminal_height);
     
@@ -18,7 +23,19 @@ void init_terminal(terminal_t *term) {
     term->canvas_width = term->terminal_width;
     term->canvas_height = term->terminal_height;
     
-    term->chars = malloc(MAX_CHARS * sizeof(character_t));
+    term->chars = calloc(MAX_CHARS, sizeof(character_t));
+    term->initial = NULL;
+    term->fb = calloc(1, sizeof(framebuffer_t));
+    if (term->fb) {
+        term->fb->full_redraw = 1;
+    }
+    term->damage = malloc(MAX_CHARS * sizeof(int));
+    term->damage_count = 0;
+    term->damage_valid = 0;
+    term->timeline = NULL;
+    term->sweep = NULL;
+    term->lanes = NULL;
+    term->easing = NULL;
     term->char_count = 0;
     term->frame_count = 0;
 }
@@ -28,15 +45,37 @@ void cleanup_terminal(terminal_t *term) {
         free(term->chars);
         term->chars = NULL;
     }
+    free(term->initial);
+    term->initial = NULL;
+    if (term->fb) {
+        free_frame_slot(&term->fb->frame);
+        free(term->fb);
+        term->fb = NULL;
+    }
+    if (term->damage) {
+        free(term->damage);
+        term->damage = NULL;
+    }
+    free_reveal_timeline(term);
+    free_sweep_mask(term);
+    free_lane_table(term);
+    if (term->easing) {
+        free(term->easing);
+        term->easing = NULL;
+    }
 }
 
 void read_input_text_with_config(terminal_t *term, config_t *config) {
+    read_input_text_from(term, config, stdin);
+}
+
+void read_input_text_from(terminal_t *term, config_t *config, FILE *input) {
     char buffer[4096];
     int row = 0;
     int col = 0;
     int max_col = 0;
     
-    while (fgets(buffer, sizeof(buffer), stdin)) {
+    while (fgets(buffer, sizeof(buffer), input)) {
         int len = strlen(buffer);
         
         // Remove trailing newline
@@ -71,6 +110,7 @@ void read_input_text_with_config(terminal_t *term, config_t *config) {
                 ch->color_fg = 15;  // Default white
                 ch->color_bg = -1;  // No background
                 ch->bold = 0;
+                ch->drawn.drawn = 0;
                 col++;
             } else {
                 col++;
@@ -107,6 +147,50 @@ void read_input_text_with_config(terminal_t *term, config_t *config) {
     }
 }
 
+// Size the canvas (0 means the whole terminal), anchor the text on it and
+// apply the initial gradient; the result is frame 0's starting state
+void place_text(terminal_t *term, config_t *config) {
+    if (config->canvas_width > 0) {
+        term->canvas_width = config->canvas_width;
+    } else if (config->canvas_width == 0) {
+        term->canvas_width = term->terminal_width;
+    }
+    if (config->canvas_height > 0) {
+        term->canvas_height = config->canvas_height;
+    } else if (config->canvas_height == 0) {
+        term->canvas_height = term->terminal_height;
+    }
+    
+    calculate_offsets(term, config->anchor_canvas, config->anchor_text);
+    double start = stats_start(config);
+    apply_initial_gradient(term, config);
+    stats_stop(config, STAT_GRADIENT, start);
+    save_initial_state(term);
+}
+
+// Set up term as a width x height terminal showing input, for renderers
+// that draw somewhere other than our own standard output. Returns -1 if
+// the terminal cannot be allocated.
+int layout_input(terminal_t *term, config_t *config, const byte_buffer_t *input, int width, int height) {
+    init_terminal(term);
+    if (!term->chars || !term->fb || !term->damage) {
+        return -1;
+    }
+    term->seed = config->seed;
+    term->terminal_width = width;
+    term->terminal_height = height;
+    term->canvas_width = width;
+    term->canvas_height = height;
+    set_terminal_easing(term, config->custom_easing ? config->easing : get_effect_easing(config->effect_name));
+    FILE *text = input->len ? fmemopen(input->data, input->len, "r") : NULL;
+    if (text) {
+        read_input_text_from(term, config, text);
+        fclose(text);
+    }
+    place_text(term, config);
+    return 0;
+}
+
 // Legacy function for backwards compatibility
 void read_input_text(terminal_t *term) {
     config_t default_config = {
@@ -117,95 +201,534 @@ void read_input_text(terminal_t *term) {
     read_input_text_with_config(term, &default_config);
 }
 
-void render_frame_with_config(terminal_t *term, config_t *config) {
-    // Create screen buffer with color info
-    static char screen[MAX_LINES][MAX_COLS];
-    static int screen_fg[MAX_LINES][MAX_COLS];
-    static int screen_bg[MAX_LINES][MAX_COLS];
-    static int screen_bold[MAX_LINES][MAX_COLS];
-    static int initialized = 0;
-    
-    if (!initialized) {
-        for (int i = 0; i < MAX_LINES; i++) {
-            for (int j = 0; j < MAX_COLS; j++) {
-                screen[i][j] = ' ';
-                screen_fg[i][j] = -1;
-                screen_bg[i][j] = -1;
-                screen_bold[i][j] = 0;
+// Select the easing curve effects use for interpolated motion
+void set_terminal_easing(terminal_t *term, easing_t easing) {
+    if (!term->easing) {
+        term->easing = malloc(sizeof(easing_lut_t));
+        if (!term->easing) {
+            return;
+        }
+    }
+    build_easing_lut(term->easing, easing);
+}
+
+// Eased motion progress; linear when no curve was selected
+float ease_motion(terminal_t *term, float t) {
+    if (!term->easing) {
+        return t < 0.0f ? 0.0f : t > 1.0f ? 1.0f : t;
+    }
+    return easing_lookup(term->easing, t);
+}
+
+// Visible screen area clipped to the framebuffer
+static int screen_rows(terminal_t *term) {
+    return term->terminal_height < MAX_LINES ? term->terminal_height : MAX_LINES;
+}
+
+static int screen_cols(terminal_t *term) {
+    return term->terminal_width < MAX_COLS ? term->terminal_width : MAX_COLS;
+}
+
+int tile_is_dirty(terminal_t *term, int row, int col) {
+    if (!term->fb || row < 0 || row >= MAX_LINES || col < 0 || col >= MAX_COLS) {
+        return 0;
+    }
+    return (term->fb->tiles[row / TILE_HEIGHT][col / TILE_WIDTH] & TILE_DIRTY) != 0;
+}
+
+// Count active characters and record which tiles still hold any of them
+int update_tile_state(terminal_t *term) {
+    int active_chars = 0;
+    framebuffer_t *fb = term->fb;
+
+    if (fb) {
+        int tile_rows = (screen_rows(term) + TILE_HEIGHT - 1) / TILE_HEIGHT;
+        int tile_cols = (screen_cols(term) + TILE_WIDTH - 1) / TILE_WIDTH;
+        for (int tr = 0; tr < tile_rows; tr++) {
+            for (int tc = 0; tc < tile_cols; tc++) {
+                fb->tiles[tr][tc] &= ~TILE_ACTIVE;
             }
         }
-        initialized = 1;
     }
-    
-    // Clear screen buffer for current canvas area
-    int start_row = term->canvas_offset_y;
-    int start_col = term->canvas_offset_x;
-    int end_row = start_row + term->canvas_height;
-    int end_col = start_col + term->canvas_width;
-    
-    for (int i = start_row; i < end_row && i < MAX_LINES; i++) {
-        for (int j = start_col; j < end_col && j < MAX_COLS; j++) {
-            screen[i][j] = ' ';
-            screen_fg[i][j] = -1;
-            screen_bg[i][j] = -1;
-            screen_bold[i][j] = 0;
+
+    // Effects that report damage already know their active count
+    int use_damage = term->damage_valid;
+    int count = use_damage ? term->damage_count : term->char_count;
+
+    for (int k = 0; k < count; k++) {
+        character_t *ch = &term->chars[use_damage ? term->damage[k] : k];
+        if (!ch->active) {
+            continue;
+        }
+        active_chars++;
+
+        if (fb) {
+            int row = ch->pos.row + term->text_offset_y + term->canvas_offset_y;
+            int col = ch->pos.col + term->text_offset_x + term->canvas_offset_x;
+            if (row >= 0 && row < MAX_LINES && col >= 0 && col < MAX_COLS) {
+                fb->tiles[row / TILE_HEIGHT][col / TILE_WIDTH] |= TILE_ACTIVE;
+            }
         }
     }
-    
-    // Render background effects if enabled
+
+    return use_damage ? term->active_count : active_chars;
+}
+
+// Move a character between per-tile lists when its drawn cell changes
+static void tile_unlink(framebuffer_t *fb, int index, int row, int col) {
+    int prev = fb->tile_prev[index];
+    int next = fb->tile_next[index];
+    if (prev) {
+        fb->tile_next[prev - 1] = next;
+    } else {
+        fb->tile_head[row / TILE_HEIGHT][col / TILE_WIDTH] = next;
+    }
+    if (next) {
+        fb->tile_prev[next - 1] = prev;
+    }
+}
+
+static void tile_link(framebuffer_t *fb, int index, int row, int col) {
+    int *head = &fb->tile_head[row / TILE_HEIGHT][col / TILE_WIDTH];
+    fb->tile_prev[index] = 0;
+    fb->tile_next[index] = *head;
+    if (*head) {
+        fb->tile_prev[*head - 1] = index + 1;
+    }
+    *head = index + 1;
+}
+
+// Mark tiles whose composited content differs from the previous frame
+void track_dirty_tiles(terminal_t *term, config_t *config) {
+    framebuffer_t *fb = term->fb;
+    int rows = screen_rows(term);
+    int cols = screen_cols(term);
+    int tile_rows = (rows + TILE_HEIGHT - 1) / TILE_HEIGHT;
+    int tile_cols = (cols + TILE_WIDTH - 1) / TILE_WIDTH;
+
+    // Any change of terminal size or anchoring invalidates the whole screen
+    int layout[6] = {
+        term->terminal_width, term->terminal_height,
+        term->canvas_offset_x, term->canvas_offset_y,
+        term->text_offset_x, term->text_offset_y
+    };
+    if (memcmp(layout, fb->layout, sizeof(layout)) != 0) {
+        memcpy(fb->layout, layout, sizeof(layout));
+        fb->full_redraw = 1;
+    }
+
+    unsigned char reset = fb->full_redraw ? TILE_DIRTY : 0;
+    for (int tr = 0; tr < tile_rows; tr++) {
+        for (int tc = 0; tc < tile_cols; tc++) {
+            fb->tiles[tr][tc] = (fb->tiles[tr][tc] & TILE_ACTIVE) | reset;
+        }
+    }
+    fb->full_redraw = 0;
+
+    // Backgrounds animate the whole canvas every frame
     if (config && config->background_effect != BACKGROUND_NONE) {
-        render_background_to_screen(screen, screen_fg, screen_bg, screen_bold, 
-                                  term, config, term->frame_count);
+        int start_row = term->canvas_offset_y < 0 ? 0 : term->canvas_offset_y;
+        int start_col = term->canvas_offset_x < 0 ? 0 : term->canvas_offset_x;
+        int end_row = term->canvas_offset_y + term->canvas_height;
+        int end_col = term->canvas_offset_x + term->canvas_width;
+        if (end_row > rows) end_row = rows;
+        if (end_col > cols) end_col = cols;
+
+        if (start_row < end_row && start_col < end_col) {
+            for (int tr = start_row / TILE_HEIGHT; tr <= (end_row - 1) / TILE_HEIGHT; tr++) {
+                for (int tc = start_col / TILE_WIDTH; tc <= (end_col - 1) / TILE_WIDTH; tc++) {
+                    fb->tiles[tr][tc] |= TILE_DIRTY;
+                }
+            }
+        }
     }
-    
-    // Place visible characters with positioning and color
-    for (int i = 0; i < term->char_count; i++) {
+
+    // Compare characters against the cell they occupied last frame; effects
+    // that report damage limit this to the characters they touched
+    int use_damage = term->damage_valid && !(reset & TILE_DIRTY);
+    int count = use_damage ? term->damage_count : term->char_count;
+    for (int k = 0; k < count; k++) {
+        int i = use_damage ? term->damage[k] : k;
         character_t *ch = &term->chars[i];
+        cell_snapshot_t now = {0};
+
         if (ch->visible) {
-            // Apply text offset and canvas offset
-            int final_row = ch->pos.row + term->text_offset_y + term->canvas_offset_y;
-            int final_col = ch->pos.col + term->text_offset_x + term->canvas_offset_x;
-            
-            if (final_row >= 0 && final_row < term->terminal_height &&
-                final_col >= 0 && final_col < term->terminal_width &&
-                final_row < MAX_LINES && final_col < MAX_COLS) {
-                screen[final_row][final_col] = ch->ch;
-                screen_fg[final_row][final_col] = ch->color_fg;
-                screen_bg[final_row][final_col] = ch->color_bg;
-                screen_bold[final_row][final_col] = ch->bold;
-            }
+            now.row = ch->pos.row + term->text_offset_y + term->canvas_offset_y;
+            now.col = ch->pos.col + term->text_offset_x + term->canvas_offset_x;
+            now.drawn = now.row >= 0 && now.row < rows && now.col >= 0 && now.col < cols;
+        }
+        if (now.drawn) {
+            now.ch = ch->ch;
+            now.color_fg = ch->color_fg;
+            now.color_bg = ch->color_bg;
+            now.bold = ch->bold;
+        }
+
+        cell_snapshot_t *last = &ch->drawn;
+        if (now.drawn == last->drawn &&
+            (!now.drawn || (now.row == last->row && now.col == last->col &&
+                            now.ch == last->ch && now.color_fg == last->color_fg &&
+                            now.color_bg == last->color_bg && now.bold == last->bold))) {
+            continue;
+        }
+
+        if (last->drawn) {
+            fb->tiles[last->row / TILE_HEIGHT][last->col / TILE_WIDTH] |= TILE_DIRTY;
+            tile_unlink(fb, i, last->row, last->col);
+        }
+        if (now.drawn) {
+            fb->tiles[now.row / TILE_HEIGHT][now.col / TILE_WIDTH] |= TILE_DIRTY;
+            tile_link(fb, i, now.row, now.col);
         }
+        *last = now;
     }
-    
-    // Output to terminal with colors
-    printf(ANSI_CURSOR_HOME);
+}
+
+// Encode one run of cells starting at an explicit position from the
+// default color state, so runs can be encoded in any order or thread
+static void encode_run(byte_buffer_t *out, const screen_run_t *run, const char *ch,
+                       const int *fg, const int *bg, const int *bold, config_t *config) {
     char color_buffer[64];
+    char cursor_buffer[32];
+    int len = snprintf(cursor_buffer, sizeof(cursor_buffer), "\033[%d;%dH", run->row + 1, run->col + 1);
+    buffer_append(out, cursor_buffer, len);
     int current_fg = -1, current_bg = -1, current_bold = 0;
-    
-    for (int i = 0; i < term->terminal_height && i < MAX_LINES; i++) {
-        for (int j = 0; j < term->terminal_width && j < MAX_COLS; j++) {
-            // Check if color needs to change
-            if (screen_fg[i][j] != current_fg || screen_bg[i][j] != current_bg || 
-                screen_bold[i][j] != current_bold) {
-                // Only output color codes if we have valid color data for non-space chars
-                if (screen[i][j] != ' ' && screen_fg[i][j] >= 0) {
-                    format_color_256_with_config(color_buffer, screen_fg[i][j], screen_bg[i][j], screen_bold[i][j], config);
-                    printf("%s", color_buffer);
-                }
-                current_fg = screen_fg[i][j];
-                current_bg = screen_bg[i][j];
-                current_bold = screen_bold[i][j];
+
+    for (int j = 0; j < run->len; j++) {
+        // Only non-space chars with valid color data need the color state
+        // changed; spaces keep whatever state was last emitted
+        if (ch[j] != ' ' && fg[j] >= 0 &&
+            (fg[j] != current_fg || bg[j] != current_bg || bold[j] != current_bold)) {
+            // Color sequences don't clear bold on their own
+            if (current_bold && !bold[j]) {
+                buffer_append(out, ANSI_RESET, sizeof(ANSI_RESET) - 1);
+            }
+            format_color_256_with_config(color_buffer, fg[j], bg[j], bold[j], config);
+            buffer_append(out, color_buffer, strlen(color_buffer));
+            current_fg = fg[j];
+            current_bg = bg[j];
+            current_bold = bold[j];
+        }
+        buffer_append(out, &ch[j], 1);
+    }
+    if (current_fg != -1 || current_bg != -1 || current_bold) {
+        buffer_append(out, ANSI_RESET, sizeof(ANSI_RESET) - 1);
+    }
+}
+
+// Grow the run and cell arrays of a frame slot; they keep their high-water
+// size so steady-state frames do not allocate
+int reserve_frame_slot(frame_slot_t *slot, int runs, int cells) {
+    if (runs > slot->run_capacity) {
+        int cap = slot->run_capacity ? slot->run_capacity : 256;
+        while (cap < runs) {
+            cap *= 2;
+        }
+        screen_run_t *new_runs = realloc(slot->runs, cap * sizeof(screen_run_t));
+        if (!new_runs) {
+            return 0;
+        }
+        slot->runs = new_runs;
+        slot->run_capacity = cap;
+    }
+    if (cells > slot->cell_capacity) {
+        int cap = slot->cell_capacity ? slot->cell_capacity : 4096;
+        while (cap < cells) {
+            cap *= 2;
+        }
+        char *ch = realloc(slot->ch, cap);
+        if (!ch) {
+            return 0;
+        }
+        slot->ch = ch;
+        int **columns[] = {&slot->fg, &slot->bg, &slot->bold};
+        for (int k = 0; k < 3; k++) {
+            int *column = realloc(*columns[k], cap * sizeof(int));
+            if (!column) {
+                return 0;
+            }
+            *columns[k] = column;
+        }
+        slot->cell_capacity = cap;
+    }
+    return 1;
+}
+
+void free_frame_slot(frame_slot_t *slot) {
+    free(slot->runs);
+    free(slot->ch);
+    free(slot->fg);
+    free(slot->bg);
+    free(slot->bold);
+    for (int b = 0; b < MAX_THREADS; b++) {
+        buffer_free(&slot->bands[b]);
+    }
+    buffer_free(&slot->trailer);
+    memset(slot, 0, sizeof(*slot));
+}
+
+// Copy the cells of a viewport out of the composited screen so the frame
+// can be encoded while the next one is being composited: the runs of
+// consecutive dirty tiles, or with whole set every cell. Runs are placed
+// at the viewport's origin on its output.
+void capture_viewport(terminal_t *term, frame_slot_t *slot, const viewport_t *view, int whole) {
+    framebuffer_t *fb = term->fb;
+    int end_row = view->y + view->height < screen_rows(term) ? view->y + view->height : screen_rows(term);
+    int end_col = view->x + view->width < screen_cols(term) ? view->x + view->width : screen_cols(term);
+
+    slot->frame = term->frame_count;
+    slot->rows = view->origin_y + view->height;
+    slot->cols = view->origin_x + view->width;
+    slot->run_count = 0;
+    slot->cell_count = 0;
+
+    for (int row = view->y; row < end_row; row++) {
+        unsigned char *tiles = fb->tiles[row / TILE_HEIGHT];
+        int col = view->x;
+        while (col < end_col) {
+            if (!whole && !(tiles[col / TILE_WIDTH] & TILE_DIRTY)) {
+                col = (col / TILE_WIDTH + 1) * TILE_WIDTH;
+                continue;
+            }
+
+            // Find the run of consecutive dirty tiles starting here
+            int run_end = whole ? end_col : col;
+            while (run_end < end_col && (tiles[run_end / TILE_WIDTH] & TILE_DIRTY)) {
+                run_end = (run_end / TILE_WIDTH + 1) * TILE_WIDTH;
+            }
+            if (run_end > end_col) {
+                run_end = end_col;
+            }
+
+            int len = run_end - col;
+            if (!reserve_frame_slot(slot, slot->run_count + 1, slot->cell_count + len)) {
+                return;  // Out of memory: emit what was captured
             }
-            putchar(screen[i][j]);
+            screen_run_t *run = &slot->runs[slot->run_count++];
+            run->row = row - view->y + view->origin_y;
+            run->col = col - view->x + view->origin_x;
+            run->len = len;
+            run->cell = slot->cell_count;
+            memcpy(slot->ch + run->cell, &fb->screen[row][col], len);
+            memcpy(slot->fg + run->cell, &fb->screen_fg[row][col], len * sizeof(int));
+            memcpy(slot->bg + run->cell, &fb->screen_bg[row][col], len * sizeof(int));
+            memcpy(slot->bold + run->cell, &fb->screen_bold[row][col], len * sizeof(int));
+            slot->cell_count += len;
+
+            col = run_end;
         }
-        if (i < term->terminal_height - 1) {
-            putchar('\n');
+    }
+}
+
+// The dirty runs of the whole screen
+void capture_frame(terminal_t *term, frame_slot_t *slot) {
+    viewport_t view = {0, 0, screen_cols(term), screen_rows(term), 0, 0};
+    capture_viewport(term, slot, &view, 0);
+}
+
+// The whole screen, one run per row, for an output that missed frames and
+// has to be redrawn from scratch
+void capture_screen(terminal_t *term, frame_slot_t *slot) {
+    viewport_t view = {0, 0, screen_cols(term), screen_rows(term), 0, 0};
+    capture_viewport(term, slot, &view, 1);
+}
+
+// Rows [rows * band / bands, rows * (band + 1) / bands) go to one band
+typedef struct {
+    frame_slot_t *slot;
+    config_t *config;
+    int bands;
+} encode_job_t;
+
+static void encode_band(void *ctx, int band) {
+    encode_job_t *job = ctx;
+    frame_slot_t *slot = job->slot;
+    byte_buffer_t *out = &slot->bands[band];
+    int first = slot->rows * band / job->bands;
+    int last = slot->rows * (band + 1) / job->bands;
+
+    out->len = 0;
+    for (int r = 0; r < slot->run_count; r++) {
+        screen_run_t *run = &slot->runs[r];
+        if (run->row >= first && run->row < last) {
+            encode_run(out, run, slot->ch + run->cell, slot->fg + run->cell,
+                       slot->bg + run->cell, slot->bold + run->cell, job->config);
         }
     }
+}
+
+// Encode the captured runs in row bands, on the pool when there is one,
+// followed by the trailer
+void encode_frame(frame_slot_t *slot, config_t *config, worker_pool_t *pool) {
+    double start = stats_start(config);
+    encode_job_t job = {slot, config, 1};
+    if (pool && slot->rows >= pool->count) {
+        job.bands = pool->count;
+        slot->band_count = job.bands;
+        worker_pool_run(pool, encode_band, &job);
+    } else {
+        slot->band_count = 1;
+        encode_band(&job, 0);
+    }
+
+    // Leave the cursor at the bottom-right corner like a full redraw would
+    slot->trailer.len = 0;
+    char cursor_buffer[32];
+    int len = snprintf(cursor_buffer, sizeof(cursor_buffer), "\033[%d;%dH", slot->rows, slot->cols);
+    buffer_append(&slot->trailer, cursor_buffer, len);
     if (!config || !config->no_color) {
-        printf(ANSI_RESET);  // Reset colors at end unless no-color is enabled
+        buffer_append(&slot->trailer, ANSI_RESET, sizeof(ANSI_RESET) - 1);  // Reset colors at end unless no-color is enabled
+    }
+    stats_stop(config, STAT_ENCODE, start);
+    stats_encoded(config, slot);
+}
+
+// Hand the bands and trailer to the output in order, in one write
+void write_frame(frame_slot_t *slot, output_t *out) {
+    struct iovec iov[MAX_THREADS + 1];
+    int count = 0;
+    for (int b = 0; b < slot->band_count; b++) {
+        if (slot->bands[b].len > 0) {
+            iov[count].iov_base = slot->bands[b].data;
+            iov[count].iov_len = slot->bands[b].len;
+            count++;
+        }
+    }
+    iov[count].iov_base = slot->trailer.data;
+    iov[count].iov_len = slot->trailer.len;
+    count++;
+    output_writev(out, iov, count);
+}
+
+// write_frame, recording its time and size for --stats
+void write_frame_timed(frame_slot_t *slot, const config_t *config, output_t *out) {
+    double start = stats_start(config);
+    unsigned long long bytes = out->bytes;
+    write_frame(slot, out);
+    if (config && config->stats) {
+        stats_stop(config, STAT_WRITE, start);
+        stats_add(config->stats, STAT_BYTES, (double)(out->bytes - bytes));
     }
-    fflush(stdout);
+}
+
+// Write a whole buffer, retrying partial writes and signals
+void write_bytes(int fd, const char *data, size_t len) {
+    while (len > 0) {
+        ssize_t written = write(fd, data, len);
+        if (written < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return;
+        }
+        data += written;
+        len -= written;
+    }
+}
+
+// Bring the composited screen up to date; returns 0 when no tile changed
+// and the frame has nothing to emit
+int composite_frame(terminal_t *term, config_t *config) {
+    framebuffer_t *fb = term->fb;
+    if (!fb) {
+        return 0;
+    }
+
+    int rows = screen_rows(term);
+    int cols = screen_cols(term);
+    int tile_rows = (rows + TILE_HEIGHT - 1) / TILE_HEIGHT;
+    int tile_cols = (cols + TILE_WIDTH - 1) / TILE_WIDTH;
+    double start = stats_start(config);
+
+    track_dirty_tiles(term, config);
+
+    // Clear dirty tiles only; clean tiles keep last frame's content
+    int any_dirty = 0;
+    for (int tr = 0; tr < tile_rows; tr++) {
+        for (int tc = 0; tc < tile_cols; tc++) {
+            if (!(fb->tiles[tr][tc] & TILE_DIRTY)) {
+                continue;
+            }
+            any_dirty = 1;
+            int end_row = (tr + 1) * TILE_HEIGHT < rows ? (tr + 1) * TILE_HEIGHT : rows;
+            int end_col = (tc + 1) * TILE_WIDTH < cols ? (tc + 1) * TILE_WIDTH : cols;
+            for (int i = tr * TILE_HEIGHT; i < end_row; i++) {
+                for (int j = tc * TILE_WIDTH; j < end_col; j++) {
+                    fb->screen[i][j] = ' ';
+                    fb->screen_fg[i][j] = -1;
+                    fb->screen_bg[i][j] = -1;
+                    fb->screen_bold[i][j] = 0;
+                }
+            }
+        }
+    }
+
+    // Nothing changed since the last frame - nothing to draw or emit
+    if (!any_dirty) {
+        stats_stop(config, STAT_COMPOSITE, start);
+        return 0;
+    }
+
+    // Render background effects if enabled; their time is kept apart from
+    // the composite's
+    if (config && config->background_effect != BACKGROUND_NONE) {
+        double background = stats_start(config);
+        render_background_to_screen(fb->screen, fb->screen_fg, fb->screen_bg, fb->screen_bold,
+                                  term, config, term->frame_count);
+        stats_stop(config, STAT_BACKGROUND, background);
+        start += stats_start(config) - background;
+    }
+
+    // Place visible characters of each dirty tile; the highest index wins a
+    // shared cell, matching a draw in character order
+    for (int tr = 0; tr < tile_rows; tr++) {
+        for (int tc = 0; tc < tile_cols; tc++) {
+            if (!(fb->tiles[tr][tc] & TILE_DIRTY) || !fb->tile_head[tr][tc]) {
+                continue;
+            }
+            int writer[TILE_HEIGHT][TILE_WIDTH];
+            memset(writer, -1, sizeof(writer));
+            for (int i = fb->tile_head[tr][tc]; i; i = fb->tile_next[i - 1]) {
+                cell_snapshot_t *cell = &term->chars[i - 1].drawn;
+                int *slot = &writer[cell->row - tr * TILE_HEIGHT][cell->col - tc * TILE_WIDTH];
+                if (i - 1 > *slot) {
+                    *slot = i - 1;
+                }
+            }
+            for (int r = 0; r < TILE_HEIGHT; r++) {
+                for (int c = 0; c < TILE_WIDTH; c++) {
+                    if (writer[r][c] < 0) {
+                        continue;
+                    }
+                    cell_snapshot_t *cell = &term->chars[writer[r][c]].drawn;
+                    fb->screen[cell->row][cell->col] = cell->ch;
+                    fb->screen_fg[cell->row][cell->col] = cell->color_fg;
+                    fb->screen_bg[cell->row][cell->col] = cell->color_bg;
+                    fb->screen_bold[cell->row][cell->col] = cell->bold;
+                }
+            }
+        }
+    }
+
+    stats_stop(config, STAT_COMPOSITE, start);
+    return 1;
+}
+
+void render_frame_to(terminal_t *term, config_t *config, output_t *out) {
+    if (!composite_frame(term, config)) {
+        return;
+    }
+    frame_slot_t *slot = &term->fb->frame;
+    capture_frame(term, slot);
+    encode_frame(slot, config, term->pool);
+    write_frame_timed(slot, config, out);
+}
+
+void render_frame_with_config(terminal_t *term, config_t *config) {
+    output_t out;
+    output_init_tty(&out, STDOUT_FILENO);
+    fflush(stdout);  // Anything already queued in stdio goes first
+    render_frame_to(term, config, &out);
 }
 
 // Legacy function for backwards compatibility
@@ -221,4 +744,30 @@ void sleep_frame(int frame_rate) {
         };
         nanosleep(&req, NULL);
     }
+}
+
+// Sleep until frames / frame_rate seconds after epoch. A deadline already
+// passed returns at once, so late frames do not push back later ones.
+// Returns 1 if the deadline had been missed.
+int sleep_until_frame(const struct timespec *epoch, int frames, int frame_rate) {
+    if (frame_rate <= 0) {
+        return 0;
+    }
+    long long offset = (long long)frames * 1000000000LL / frame_rate;
+    struct timespec deadline = *epoch;
+    deadline.tv_sec += offset / 1000000000LL;
+    deadline.tv_nsec += offset % 1000000000LL;
+    if (deadline.tv_nsec >= 1000000000L) {
+        deadline.tv_sec++;
+        deadline.tv_nsec -= 1000000000L;
+    }
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    if (now.tv_sec > deadline.tv_sec || (now.tv_sec == deadline.tv_sec && now.tv_nsec > deadline.tv_nsec)) {
+        return 1;
+    }
+    while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &deadline, NULL) == EINTR) {
+        // Interrupted by a signal; the absolute deadline is unchanged
+    }
+    return 0;
 }
\ No newline at end of file
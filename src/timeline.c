@@ -0,0 +1,135 @@
+#include "tte.h"
+
+// Start frame and character index pair used while sorting
+typedef struct {
+    int start;
+    int index;
+} reveal_entry_t;
+
+static int compare_reveal_entries(const void *a, const void *b) {
+    const reveal_entry_t *ea = a;
+    const reveal_entry_t *eb = b;
+    if (ea->start != eb->start) {
+        return (ea->start < eb->start) ? -1 : 1;
+    }
+    return (ea->index < eb->index) ? -1 : (ea->index > eb->index);
+}
+
+void free_reveal_timeline(terminal_t *term) {
+    reveal_timeline_t *tl = term->timeline;
+    if (tl) {
+        free(tl->order);
+        free(tl->start);
+        free(tl->inflight);
+        free(tl);
+        term->timeline = NULL;
+    }
+}
+
+// Make the next step replay the queue from the beginning, for callers that
+// have restored the characters to their initial state
+void rewind_reveal_timeline(terminal_t *term) {
+    if (term->timeline) {
+        term->timeline->last_frame = INT_MAX;
+    }
+}
+
+// Sort every character by start frame once; later frames only walk forward
+static reveal_timeline_t *build_reveal_timeline(terminal_t *term, effect_func_t owner,
+                                                reveal_start_func_t start_func) {
+    free_reveal_timeline(term);
+
+    reveal_timeline_t *tl = calloc(1, sizeof(reveal_timeline_t));
+    reveal_entry_t *entries = malloc((term->char_count + 1) * sizeof(reveal_entry_t));
+    if (!tl || !entries) {
+        free(tl);
+        free(entries);
+        return NULL;
+    }
+    tl->order = malloc((term->char_count + 1) * sizeof(int));
+    tl->start = malloc((term->char_count + 1) * sizeof(int));
+    tl->inflight = malloc((term->char_count + 1) * sizeof(int));
+    term->timeline = tl;
+    if (!tl->order || !tl->start || !tl->inflight) {
+        free(entries);
+        free_reveal_timeline(term);
+        return NULL;
+    }
+
+    for (int i = 0; i < term->char_count; i++) {
+        entries[i].start = start_func(term, i);
+        entries[i].index = i;
+        tl->start[i] = entries[i].start;
+    }
+    qsort(entries, term->char_count, sizeof(reveal_entry_t), compare_reveal_entries);
+    for (int i = 0; i < term->char_count; i++) {
+        tl->order[i] = entries[i].index;
+    }
+    free(entries);
+
+    tl->count = term->char_count;
+    tl->text_width = term->text_width;
+    tl->text_height = term->text_height;
+    tl->owner = owner;
+    tl->last_frame = -1;
+    return tl;
+}
+
+static void push_damage(terminal_t *term, int index) {
+    if (term->damage && term->damage_count < MAX_CHARS) {
+        term->damage[term->damage_count++] = index;
+    }
+}
+
+// Advance a reveal effect to the given frame touching only characters that
+// start this frame or are still in flight, and report them as damage
+void run_reveal_timeline(terminal_t *term, int frame, effect_func_t owner,
+                         reveal_start_func_t start_func, reveal_step_func_t step_func) {
+    reveal_timeline_t *tl = term->timeline;
+
+    if (!tl || tl->owner != owner || tl->count != term->char_count ||
+        tl->text_width != term->text_width || tl->text_height != term->text_height) {
+        tl = build_reveal_timeline(term, owner, start_func);
+        if (!tl) {
+            return;
+        }
+    }
+
+    // Stepping backwards replays the queue from the beginning
+    if (frame < tl->last_frame) {
+        tl->next = 0;
+        tl->inflight_count = 0;
+    }
+    tl->last_frame = frame;
+
+    term->damage_count = 0;
+    int inflight_active = 0;
+
+    // Characters already in flight, compacting out those that finished
+    int kept = 0;
+    for (int k = 0; k < tl->inflight_count; k++) {
+        int i = tl->inflight[k];
+        int still_changing = step_func(term, i, tl->start[i], frame);
+        push_damage(term, i);
+        if (still_changing) {
+            tl->inflight[kept++] = i;
+            inflight_active += term->chars[i].active;
+        }
+    }
+    tl->inflight_count = kept;
+
+    // Characters whose start frame has arrived
+    while (tl->next < tl->count && tl->start[tl->order[tl->next]] <= frame) {
+        int i = tl->order[tl->next++];
+        int still_changing = step_func(term, i, tl->start[i], frame);
+        push_damage(term, i);
+        if (still_changing) {
+            tl->inflight[tl->inflight_count++] = i;
+            inflight_active += term->chars[i].active;
+        }
+    }
+
+    // Characters that have not started yet are still active
+    term->active_count = (tl->count - tl->next) + inflight_active;
+    term->damage_valid = (term->damage != NULL);
+}
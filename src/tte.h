@@ -1,8 +1,8 @@
 #ifndef TTE_H
 #define TTE_H
 
-// For nanosleep and timespec
-#define _POSIX_C_SOURCE 199309L
+// For nanosleep, timespec and pthreads
+#define _POSIX_C_SOURCE 200809L
 #define _USE_MATH_DEFINES
 
 #include <stdio.h>
@@ -13,6 +13,22 @@
 #include <termios.h>
 #include <time.h>
 #include <math.h>
+#include <stdint.h>
+#include <limits.h>
+#include <pthread.h>
+#include <errno.h>
+#include <sys/uio.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <stddef.h>
+#include <dirent.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <signal.h>
+#include <poll.h>
+
+#include "tte_shm.h"
 
 #ifndef M_PI
 #define M_PI 3.14159265358979323846
@@ -20,8 +36,44 @@
 
 #define MAX_LINES 1024
 #define MAX_COLS 1024
-#define MAX_CHARS 65536
+#define MAX_CHARS 262144
+#define MAX_THREADS 64
+#define DEFAULT_LOOKAHEAD 8  // Frames the effect may run ahead of the terminal
+#define MAX_LOOKAHEAD 256
+#define MAX_FRAMES 1000     // Animations stop here even if still active
+#define MIN_FRAMES 60       // Settled animations still run at least this long
+#define OFFLINE_CHUNK 32    // Frames per offline work unit
 #define DEFAULT_FRAME_RATE 240
+#define DEFAULT_RECORD_WIDTH 80   // Virtual terminal size for --record
+#define DEFAULT_RECORD_HEIGHT 24
+#define MAX_OUTPUTS 16             // Terminals one --output run can draw on
+#define OUTPUT_DRAIN_MS 1000        // Wait for a slow --output target at the end
+
+// Saved animation files (--save / --play)
+#define ANIM_MAGIC "TTEA"
+#define ANIM_VERSION 1
+#define ANIM_HEADER_SIZE 32
+#define ANIM_FLAG_LZ 1              // Records are one LZ-compressed block
+#define ANIM_KEYFRAME_INTERVAL 64   // Frames between full-screen records
+#define DEFAULT_CACHE_LIMIT (64LL << 20)  // Bytes kept by --cache
+
+// --serve / --connect requests
+#define SERVE_MAGIC 0x51455454u     // "TTEQ", little-endian
+#define SERVE_MAX_ARGS 256
+#define SERVE_MAX_ARGS_LEN 65536
+#define SERVE_MAX_INPUT (16 << 20)
+// Default seed; picks the radial default gradient the unseeded libc rand()
+// always produced before effects had their own generator
+#define DEFAULT_SEED 2
+
+// Dirty-tile tracking: the screen is partitioned into fixed tiles so that
+// clear, background, scatter and encode only touch regions that changed
+#define TILE_WIDTH 16
+#define TILE_HEIGHT 8
+#define TILE_COLS (MAX_COLS / TILE_WIDTH)
+#define TILE_ROWS (MAX_LINES / TILE_HEIGHT)
+#define TILE_DIRTY 0x01    // Tile content changed and must be recomposited
+#define TILE_ACTIVE 0x02   // Tile holds at least one active character
 
 // ANSI escape sequences
 #define ANSI_CLEAR_SCREEN "\033[2J"
@@ -66,6 +118,23 @@ typedef enum {
     EASE_IN_BOUNCE, EASE_OUT_BOUNCE, EASE_IN_OUT_BOUNCE
 } easing_t;
 
+// Easing curves are sampled into a table and linearly interpolated
+#define EASING_LUT_SIZE 1024
+
+typedef struct {
+    easing_t easing;
+    float samples[EASING_LUT_SIZE + 1];
+} easing_lut_t;
+
+// Independent random sequences, one per consumer
+typedef enum {
+    RANDOM_STREAM_GRADIENT,
+    RANDOM_STREAM_BURN,
+    RANDOM_STREAM_DECRYPT,
+    RANDOM_STREAM_CRUMBLE,
+    RANDOM_STREAM_SYNTHGRID
+} random_stream_t;
+
 // Background effect types
 typedef enum {
     BACKGROUND_NONE,
@@ -105,6 +174,17 @@ typedef struct {
     int col;
 } coord_t;
 
+// Screen cell a character occupied when it was last composited
+typedef struct {
+    int drawn;         // Character was visible and on screen
+    int row;
+    int col;
+    char ch;
+    int color_fg;
+    int color_bg;
+    int bold;
+} cell_snapshot_t;
+
 typedef struct {
     char ch;
     char original_ch;  // Store original character for decrypt effect
@@ -116,8 +196,41 @@ typedef struct {
     int color_fg;      // 256-color foreground
     int color_bg;      // 256-color background
     int bold;
+    cell_snapshot_t drawn;  // Last composited state for dirty-tile tracking
 } character_t;
 
+// Per-frame measurements collected with --stats (stats.c)
+typedef enum {
+    STAT_EFFECT,              // Stage timings, in seconds
+    STAT_GRADIENT,
+    STAT_BACKGROUND,
+    STAT_COMPOSITE,
+    STAT_ENCODE,
+    STAT_WRITE,
+    STAT_BYTES,               // Per-frame counts
+    STAT_SGR,
+    STAT_CELLS,
+    STAT_SERIES
+} stat_series_id_t;
+
+typedef enum {
+    STATS_OFF,
+    STATS_TEXT,
+    STATS_JSON
+} stats_format_t;
+
+typedef struct {
+    double *samples;
+    size_t count;
+    size_t capacity;
+} stat_series_t;
+
+typedef struct {
+    pthread_mutex_t lock;     // Stages record from effect, encoder and writer threads
+    stat_series_t series[STAT_SERIES];
+    unsigned long missed;     // Frames written after their deadline
+} stats_t;
+
 typedef struct {
     int frame_rate;
     int canvas_width;
@@ -148,10 +261,181 @@ typedef struct {
     int tab_width;
     int xterm_colors;  // Force 8-bit color mode
     int no_color;      // Disable all colors
+    easing_t easing;   // Motion easing for effects that interpolate
+    int custom_easing; // Easing given on the command line
+    unsigned int seed; // Seed for all random choices
+    int custom_seed;   // Seed given on the command line
+    int threads;       // Worker threads for effect stepping
+    int lookahead;     // Frames computed ahead while waiting for deadlines
+    int start_frame;   // First frame shown; earlier frames are skipped
+    int offline;       // Render as fast as possible, frame ranges in parallel
+    const char *record_path;  // asciicast file to render into instead of the terminal
+    int record_width;         // Virtual terminal size while recording
+    int record_height;
+    const char *save_path;    // Saved animation to render into
+    const char *play_path;    // Saved animation to play instead of an effect
+    int compress;             // LZ-compress saved animations
+    int custom_frame_rate;    // Frame rate given on the command line
+    int cache;                // Replay rendered animations from the cache
+    long long cache_limit;    // Bytes the cache may hold before eviction
+    const char *bake_path;    // C source to bake the animation into
+    const char *serve_path;   // UNIX socket to serve animations on
+    const char *connect_path; // Daemon socket to hand the animation to
+    const char *shm_name;     // Shared-memory object to publish frames in
+    const char *sink;         // Output backend for the animation (tty, null, memory, file:PATH)
+    const char *outputs[MAX_OUTPUTS];  // Terminals to draw on instead of standard output
+    int output_count;
+    int wall_columns;         // Tile the outputs into a wall of columns x rows
+    int wall_rows;
+    const char *batch_path;   // Manifest of jobs to render headless
+    int hangup_fd;            // Daemon: client connection; stop drawing once it hangs up (-1: none)
+    stats_format_t stats_format;  // Report per-frame stage timings at exit
+    const char *stats_path;   // File for the report instead of stderr
+    stats_t *stats;           // Collector, NULL unless --stats
 } config_t;
 
+// Growable output byte buffer
+typedef struct {
+    char *data;
+    size_t len;
+    size_t cap;
+} byte_buffer_t;
+
+// Run of consecutive dirty cells on one screen row
+typedef struct {
+    int row;
+    int col;
+    int len;
+    int cell;                 // First cell of the run in the slot's cell arrays
+} screen_run_t;
+
+// Region of the screen drawn on one output: width x height cells from
+// (x, y), landing at (origin_x, origin_y) on that output
+typedef struct {
+    int x;
+    int y;
+    int width;
+    int height;
+    int origin_x;
+    int origin_y;
+} viewport_t;
+
+// Dirty runs of one composited frame and their encoded bytes; composite,
+// encode and write can each work on a different slot
+typedef struct {
+    screen_run_t *runs;
+    int run_count;
+    int run_capacity;
+    char *ch;
+    int *fg;
+    int *bg;
+    int *bold;
+    int cell_count;
+    int cell_capacity;
+    int frame;                // Frame number, which sets its write deadline
+    int rows;
+    int cols;
+    byte_buffer_t bands[MAX_THREADS];  // Encoded row bands, written in order
+    int band_count;
+    byte_buffer_t trailer;    // Final cursor position and reset
+} frame_slot_t;
+
+// Output backend (output.c): where escape codes go
+typedef struct output output_t;
+
+typedef struct {
+    const char *name;
+    int (*write)(output_t *out, const struct iovec *iov, int count);  // 0, or -1 on failure
+    void (*close)(output_t *out);
+    int (*flush)(output_t *out);  // Optional: 1 once nothing is left to write
+} output_ops_t;
+
+struct output {
+    const output_ops_t *ops;
+    int fd;                   // tty, nonblocking: descriptor written to
+    FILE *file;               // file: stream written to
+    byte_buffer_t buffer;     // memory: everything written; nonblocking: bytes queued
+    size_t sent;              // nonblocking: bytes of buffer already written
+    unsigned long long bytes; // Bytes handed to the backend
+    unsigned long writes;     // Calls, one per frame plus prologue and epilogue
+    int failed;
+};
+
+// asciicast v2 recording being written
+typedef struct {
+    FILE *file;
+    int frame_rate;
+    int first_frame;          // Frame stamped at time 0
+    double time;              // Timestamp of the last event, in seconds
+} asciicast_t;
+
+// Shared-memory framebuffer ring being written (--shm)
+typedef struct {
+    tte_shm_header_t *header;
+    size_t size;
+    int rows;
+    int cols;
+    char name[256];
+} shm_export_t;
+
+// Screen contents rebuilt from saved frame records
+typedef struct {
+    int rows;
+    int cols;
+    char *ch;
+    int *fg;
+    int *bg;
+    int *bold;
+} anim_screen_t;
+
+// Saved animation being collected in memory until it is written out
+typedef struct {
+    int rows;
+    int cols;
+    int frame_rate;
+    int compress;
+    byte_buffer_t data;       // Records back to back
+    byte_buffer_t frames;     // Index of frame records
+    byte_buffer_t keyframes;  // Index of full-screen records
+    int frame_count;
+    int keyframe_count;
+    int next_keyframe;        // Frame due the next full-screen record
+    anim_screen_t screen;     // Screen as the saved frames leave it
+    frame_slot_t slot;        // Scratch for decoding and keyframes
+    int failed;
+} anim_writer_t;
+
+// Composited screen with per-tile dirty/settled state
+typedef struct {
+    char screen[MAX_LINES][MAX_COLS];
+    int screen_fg[MAX_LINES][MAX_COLS];
+    int screen_bg[MAX_LINES][MAX_COLS];
+    int screen_bold[MAX_LINES][MAX_COLS];
+    unsigned char tiles[TILE_ROWS][TILE_COLS];
+    // Characters drawn in each tile as doubly linked lists (index + 1, 0 = none)
+    int tile_head[TILE_ROWS][TILE_COLS];
+    int tile_next[MAX_CHARS];
+    int tile_prev[MAX_CHARS];
+    int full_redraw;          // Next frame must recomposite every tile
+    int layout[6];            // Terminal size and offsets of the last frame
+    frame_slot_t frame;       // Captured and encoded frame for direct rendering
+} framebuffer_t;
+
+typedef struct reveal_timeline reveal_timeline_t;
+typedef struct worker_pool worker_pool_t;
+typedef struct frame_pipeline frame_pipeline_t;
+typedef struct sweep_mask sweep_mask_t;
+typedef struct lane_table lane_table_t;
+
 typedef struct {
     character_t *chars;
+    character_t *initial;  // Characters before frame 0, for seeking
+    framebuffer_t *fb;
+    reveal_timeline_t *timeline;
+    sweep_mask_t *sweep;
+    lane_table_t *lanes;
+    easing_lut_t *easing;  // Motion easing curve used by effects
+    worker_pool_t *pool;   // Optional threads for stepping and encoding
     int char_count;
     int terminal_width;
     int terminal_height;
@@ -164,20 +448,315 @@ typedef struct {
     int text_offset_x;
     int text_offset_y;
     int frame_count;
+    unsigned int seed;  // Seed for effect randomness
+    int char_base;      // Index of chars[0] in the whole text (worker views)
+    
+    // Damage reported by effects that track their own changes. When
+    // damage_valid is set only the listed characters changed this frame.
+    int *damage;
+    int damage_count;
+    int damage_valid;
+    int active_count;  // Active characters, valid with damage_valid
 } terminal_t;
 
 // Effect function pointer type
 typedef void (*effect_func_t)(terminal_t *term, int frame);
 
+// Effect registry entry
+#define EFFECT_PARALLEL 0x01  // Characters step independently of each other
+
+typedef struct {
+    const char *name;
+    effect_func_t func;
+    int flags;
+} effect_info_t;
+
+// Work run on every pool worker; worker 0 is the calling thread
+typedef void (*worker_job_t)(void *ctx, int worker);
+
+// Persistent pool stepping character ranges of one effect in parallel
+// and encoding row bands of the frame
+struct worker_pool {
+    int count;                // Workers including the calling thread
+    pthread_t *threads;
+    terminal_t *views;        // Per-worker view of its character range
+    pthread_mutex_t lock;
+    pthread_mutex_t run_lock; // Serializes jobs submitted from different threads
+    pthread_cond_t start;
+    pthread_cond_t done;
+    int generation;           // Bumped to release workers for a frame
+    int pending;              // Workers still stepping this frame
+    int shutdown;
+    worker_job_t job;
+    void *job_ctx;
+    effect_func_t func;       // Effect being stepped by worker_pool_step
+    int frame;
+};
+
+// Composite -> encode -> write pipeline. Each stage owns one cursor into
+// a ring of frame slots and only advances it; slot n % depth is free for
+// compositing once written passes n - depth, encodable once composited
+// passes n and writable once encoded passes n. The I/O thread holds each
+// frame until its deadline, so the stages before it fill the ring ahead.
+struct frame_pipeline {
+    frame_slot_t *slots;
+    int depth;
+    config_t *config;
+    worker_pool_t *pool;      // Optional threads for band encoding
+    output_t *out;
+    struct timespec epoch;    // Deadline of the first frame
+    int first_frame;          // Frame number of the first frame written, or -1
+    unsigned long composited; // Frames captured by the compute thread
+    unsigned long encoded;    // Frames encoded by the encoder thread
+    unsigned long written;    // Frames written by the I/O thread
+    pthread_t encoder;
+    pthread_t writer;
+    // Slow path for a stage that finds the ring empty or full
+    pthread_mutex_t lock;
+    pthread_cond_t wake;
+    int sleepers;
+    int shutdown;
+};
+
+// Reveal timeline callbacks: start frame of a character, and its update
+// once started (returns 1 while the character keeps changing every frame)
+typedef int (*reveal_start_func_t)(terminal_t *term, int index);
+typedef int (*reveal_step_func_t)(terminal_t *term, int index, int start_frame, int frame);
+
+// Time-sorted reveal queue for effects whose characters start at fixed frames
+struct reveal_timeline {
+    int *order;           // Character indices sorted by start frame
+    int *start;           // Start frame of each character
+    int *inflight;        // Started characters that still change every frame
+    int count;
+    int next;             // First entry in order that has not started yet
+    int inflight_count;
+    int last_frame;
+    int text_width;
+    int text_height;
+    effect_func_t owner;
+};
+
+// Coordinate a sweep band moves along
+typedef enum {
+    SWEEP_COLS,       // Vertical edge moving right (u = col)
+    SWEEP_ROWS,       // Horizontal edge moving down (u = row)
+    SWEEP_DIAG_DOWN,  // Diagonal edge (u = col - row)
+    SWEEP_DIAG_UP     // Anti-diagonal edge (u = col + row)
+} sweep_axis_t;
+
+// Reveal and highlight bitmasks over the text grid, 64 cells per word
+struct sweep_mask {
+    int width;
+    int height;
+    int words;            // 64-bit words per row
+    uint64_t *reveal;     // Cells a primitive covers or has passed
+    uint64_t *highlight;  // Cells a primitive currently covers
+    float *distance;      // Cached distance of each cell from the center
+    int center_row;
+    int center_col;
+    int char_count;       // Text layout the grid was sized for
+    int text_width;
+    int text_height;
+};
+
+// Lane (column or row) progress shared by every character in it
+typedef enum {
+    LANE_WAITING,   // Lane has not started yet
+    LANE_RUNNING,   // Lane is animating
+    LANE_DONE       // Lane has settled
+} lane_phase_t;
+
+typedef struct {
+    lane_phase_t phase;
+    int start;      // Frame the lane starts
+    int head;       // Leading edge position along the lane
+    int shift;      // Lane-wide offset applied to its characters
+} lane_state_t;
+
+// Per-column and per-row lane state, updated once per frame
+struct lane_table {
+    lane_state_t *cols;
+    lane_state_t *rows;
+    int width;
+    int height;
+    int char_count;       // Text layout the table was sized for
+    int text_width;
+    int text_height;
+};
+
+// Incremental sine/cosine for angles advancing by a constant step; the
+// exact value is re-derived every PHASOR_RESYNC steps to cancel drift
+#define PHASOR_RESYNC 64
+
+typedef struct {
+    float s;              // sin and cos of the current angle
+    float c;
+    float step_s;         // sin and cos of the step
+    float step_c;
+    float start;          // Angle of the first value
+    float step;
+    int n;                // Steps taken since start
+} phasor_t;
+
 // Core functions
 void init_terminal(terminal_t *term);
 void cleanup_terminal(terminal_t *term);
 void get_terminal_size(int *width, int *height);
+void get_fd_size(int fd, int *width, int *height);
 void read_input_text(terminal_t *term);
 void read_input_text_with_config(terminal_t *term, config_t *config);
+void read_input_text_from(terminal_t *term, config_t *config, FILE *input);
+void place_text(terminal_t *term, config_t *config);
+int layout_input(terminal_t *term, config_t *config, const byte_buffer_t *input, int width, int height);
 void render_frame(terminal_t *term);
 void render_frame_with_config(terminal_t *term, config_t *config);
+void render_frame_to(terminal_t *term, config_t *config, output_t *out);
+int composite_frame(terminal_t *term, config_t *config);
+int reserve_frame_slot(frame_slot_t *slot, int runs, int cells);
+void capture_frame(terminal_t *term, frame_slot_t *slot);
+void capture_screen(terminal_t *term, frame_slot_t *slot);
+void capture_viewport(terminal_t *term, frame_slot_t *slot, const viewport_t *view, int whole);
+void encode_frame(frame_slot_t *slot, config_t *config, worker_pool_t *pool);
+void write_frame(frame_slot_t *slot, output_t *out);
+void write_frame_timed(frame_slot_t *slot, const config_t *config, output_t *out);
+void write_bytes(int fd, const char *data, size_t len);
+void free_frame_slot(frame_slot_t *slot);
 void sleep_frame(int frame_rate);
+int sleep_until_frame(const struct timespec *epoch, int frames, int frame_rate);
+void set_terminal_easing(terminal_t *term, easing_t easing);
+float ease_motion(terminal_t *term, float t);
+
+// Dirty-tile tracking
+int update_tile_state(terminal_t *term);
+void track_dirty_tiles(terminal_t *term, config_t *config);
+int tile_is_dirty(terminal_t *term, int row, int col);
+
+// Reveal timeline
+void run_reveal_timeline(terminal_t *term, int frame, effect_func_t owner,
+                         reveal_start_func_t start_func, reveal_step_func_t step_func);
+void rewind_reveal_timeline(terminal_t *term);
+void free_reveal_timeline(terminal_t *term);
+
+// Sweep mask engine
+sweep_mask_t *sweep_begin(terminal_t *term);
+void sweep_band(sweep_mask_t *mask, sweep_axis_t axis, float pos, float half_width,
+                int cross_lo, int cross_hi);
+void sweep_ring(sweep_mask_t *mask, int center_row, int center_col, float radius, float half_width);
+void sweep_circle(sweep_mask_t *mask, int center_row, int center_col, float radius);
+void sweep_disc(sweep_mask_t *mask, int center_row, int center_col, int radius);
+int sweep_revealed(const sweep_mask_t *mask, int row, int col);
+int sweep_highlighted(const sweep_mask_t *mask, int row, int col);
+void free_sweep_mask(terminal_t *term);
+
+// Worker pool
+worker_pool_t *worker_pool_create(int threads);
+void worker_pool_run(worker_pool_t *pool, worker_job_t job, void *ctx);
+void worker_pool_step(worker_pool_t *pool, terminal_t *term, effect_func_t func, int frame);
+void worker_pool_destroy(worker_pool_t *pool);
+
+// Seeking and offline rendering
+typedef void (*frame_output_t)(void *ctx, int frame, const char *data, size_t len);
+typedef void (*frame_format_t)(frame_slot_t *slot, config_t *config, byte_buffer_t *out);
+void format_ansi_frame(frame_slot_t *slot, config_t *config, byte_buffer_t *out);
+void save_initial_state(terminal_t *term);
+void rewind_effect(terminal_t *term);
+void seek_effect(terminal_t *term, effect_func_t func, int frame);
+int advance_effect(terminal_t *term, config_t *config, effect_func_t func, worker_pool_t *pool, int frame);
+int animation_finished(int active_chars, int frame);
+int render_offline(terminal_t *term, config_t *config, effect_func_t func, worker_pool_t *pool,
+                   int first_frame, frame_format_t format, frame_output_t output, void *ctx);
+
+// asciicast recording
+int asciicast_open(asciicast_t *cast, const char *path, int width, int height, int frame_rate);
+void asciicast_frame(void *ctx, int frame, const char *data, size_t len);
+int asciicast_close(asciicast_t *cast, int final_newline);
+
+// Output backends
+void output_init_tty(output_t *out, int fd);
+int output_init_file(output_t *out, const char *path);
+void output_init_memory(output_t *out);
+void output_init_null(output_t *out);
+void output_init_nonblocking(output_t *out, int fd);
+int output_init_sink(output_t *out, const char *sink);
+int output_writev(output_t *out, const struct iovec *iov, int count);
+int output_write(output_t *out, const char *data, size_t len);
+int output_flush(output_t *out);
+size_t output_pending(const output_t *out);
+int output_close(output_t *out);
+
+// Shared-memory framebuffer export
+int shm_export_open(shm_export_t *shm, const char *name, int rows, int cols, int frame_rate);
+void shm_export_frame(shm_export_t *shm, const framebuffer_t *fb, int frame);
+void shm_export_close(shm_export_t *shm);
+int shm_animate(terminal_t *term, config_t *config, const effect_info_t *effect, worker_pool_t *pool);
+
+// Fan-out to several terminals
+int fanout_animation(config_t *config, const effect_info_t *effect, const byte_buffer_t *input);
+
+// Saved animations
+void format_delta_frame(frame_slot_t *slot, config_t *config, byte_buffer_t *out);
+int anim_writer_init(anim_writer_t *writer, int rows, int cols, int frame_rate, int compress);
+void anim_writer_frame(void *ctx, int frame, const char *data, size_t len);
+int anim_writer_finish(anim_writer_t *writer, const char *path);
+int play_animation(const char *path, config_t *config, output_t *out);
+uint64_t cache_key(const terminal_t *term, const config_t *config, const char *input, size_t len);
+int cache_directory(char *dir, size_t size);
+void cache_evict(const char *dir, long long limit);
+int cache_play(terminal_t *term, config_t *config, effect_func_t func, worker_pool_t *pool,
+               const char *input, size_t len, output_t *out);
+int bake_animation(terminal_t *term, config_t *config, effect_func_t func, worker_pool_t *pool,
+                   const char *path);
+int lz_compress(const char *src, size_t len, byte_buffer_t *out);
+int lz_decompress(const char *src, size_t len, char *dst, size_t dst_len);
+
+// Frame pipeline
+frame_pipeline_t *frame_pipeline_create(config_t *config, worker_pool_t *pool, output_t *out, int depth);
+void frame_pipeline_submit(frame_pipeline_t *pipeline, terminal_t *term);
+void frame_pipeline_drain(frame_pipeline_t *pipeline);
+void frame_pipeline_cancel(frame_pipeline_t *pipeline);
+void frame_pipeline_destroy(frame_pipeline_t *pipeline);
+void show_animation(terminal_t *term, config_t *config, const effect_info_t *effect, worker_pool_t *pool,
+                    const byte_buffer_t *input, output_t *out);
+int render_headless(terminal_t *term, config_t *config, const effect_info_t *effect, worker_pool_t *pool);
+int run_batch(config_t *config, const char *path);
+
+// Frame statistics
+void stats_init(stats_t *stats);
+void stats_free(stats_t *stats);
+void stats_add(stats_t *stats, int series, double value);
+void stats_merge(stats_t *stats, stats_t *from);
+void stats_clear(stats_t *stats);
+double stats_start(const config_t *config);
+void stats_stop(const config_t *config, int series, double start);
+void stats_missed(const config_t *config);
+void stats_encoded(const config_t *config, const frame_slot_t *slot);
+int stats_report(stats_t *stats, const config_t *config);
+
+// Animation daemon
+int serve_listen(const char *path);
+void serve_client(int conn);
+int serve(const char *path);
+int serve_connect(const char *path, int argc, char *argv[], const byte_buffer_t *input, int fd, int *status);
+int serve_animation(config_t *config, const byte_buffer_t *input, int fd);
+int serve_hung_up(const config_t *config);
+
+// Counter-based random numbers
+uint32_t random_u32(unsigned int seed, random_stream_t stream, uint32_t index, uint32_t counter);
+int random_range(unsigned int seed, random_stream_t stream, uint32_t index, uint32_t counter, int n);
+
+// Fast trigonometry
+void fast_sincosf(float x, float *s, float *c);
+float fast_sinf(float x);
+float fast_cosf(float x);
+float fast_sqrtf(float x);
+void phasor_init(phasor_t *p, float start, float step);
+void phasor_seek(phasor_t *p, int n);
+void phasor_next(phasor_t *p);
+
+// Lane state
+lane_table_t *lanes_begin(terminal_t *term);
+void free_lane_table(terminal_t *term);
 
 // Effect functions
 void effect_beams(terminal_t *term, int frame);
@@ -203,10 +782,17 @@ void effect_rings(terminal_t *term, int frame);
 void effect_synthgrid(terminal_t *term, int frame);
 
 // Utility functions
-void parse_args(int argc, char *argv[], config_t *config);
+void init_config(config_t *config);
+int parse_args(int argc, char *argv[], config_t *config);
 effect_func_t get_effect_function(const char *effect_name);
+const effect_info_t *find_effect(const char *effect_name);
 void print_usage(const char *program_name);
 anchor_t parse_anchor(const char *anchor_str);
+int parse_easing(const char *easing_str, easing_t *easing);
+easing_t get_effect_easing(const char *effect_name);
+void buffer_append(byte_buffer_t *buf, const char *data, size_t len);
+void buffer_read_file(byte_buffer_t *buf, FILE *file);
+void buffer_free(byte_buffer_t *buf);
 
 // Color functions
 void format_color_256(char *buffer, int fg, int bg, int bold);
@@ -221,10 +807,16 @@ void apply_initial_gradient(terminal_t *term, config_t *config);
 void apply_final_gradient(terminal_t *term, config_t *config);
 
 // Anchoring functions
+void anchor_offset(anchor_t anchor, int outer_width, int outer_height, int inner_width, int inner_height,
+                   int *x, int *y);
 void calculate_offsets(terminal_t *term, anchor_t canvas_anchor, anchor_t text_anchor);
+void tile_viewport(viewport_t *view, int index, int columns, int tile_width, int tile_height,
+                   int screen_width, int screen_height, anchor_t anchor);
 
 // Easing functions
 float apply_easing(float t, easing_t easing);
+void build_easing_lut(easing_lut_t *lut, easing_t easing);
+float easing_lookup(const easing_lut_t *lut, float t);
 float ease_in_quad(float t);
 float ease_out_quad(float t);
 float ease_in_out_quad(float t);
@@ -246,7 +838,8 @@ rgb_color_t color_wheel(float position);
 // Advanced gradient functions
 void setup_gradient_preset(config_t *config, gradient_preset_t preset);
 void parse_gradient_colors(config_t *config, const char *colors_string);
-void generate_auto_gradient(config_t *config, int seed);
+void generate_auto_gradient(config_t *config, unsigned int seed);
+void resolve_gradient(config_t *config);
 
 // Background effects
 void render_background(terminal_t *term, config_t *config, int frame);
@@ -0,0 +1,97 @@
+#ifndef TTE_SHM_H
+#define TTE_SHM_H
+
+#include <stdint.h>
+#include <string.h>
+
+// Layout of the shared-memory framebuffer written by `tte-c --shm NAME`.
+//
+// The object holds a header and a ring of TTE_SHM_SLOTS full screens of
+// packed cells. Each composited frame goes into the next slot, guarded by
+// that slot's sequence number (odd while it is being written), and then
+// published is bumped. Readers never block the writer: they read the
+// newest slot in place and retry if its sequence moved underneath them.
+//
+//     int fd = shm_open("/tte", O_RDONLY, 0);
+//     struct stat st;
+//     fstat(fd, &st);
+//     const tte_shm_header_t *shm = mmap(NULL, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+//     tte_shm_cell_t cells[...rows * cols...];
+//     uint64_t seen = 0;
+//     while (!(shm->flags & TTE_SHM_DONE)) {
+//         if (tte_shm_read(shm, cells, &seen) > 0) {
+//             draw(cells);
+//         }
+//         ...wait for the next frame of shm->frame_rate
+//     }
+
+#define TTE_SHM_MAGIC "TTES"
+#define TTE_SHM_VERSION 1
+#define TTE_SHM_SLOTS 4
+
+// tte_shm_cell_t attributes
+#define TTE_SHM_BOLD 1
+#define TTE_SHM_FG 2              // fg holds a color; otherwise the terminal default
+#define TTE_SHM_BG 4
+
+typedef struct {
+    uint32_t glyph;           // Character code
+    uint8_t fg;               // xterm 256-color indices
+    uint8_t bg;
+    uint8_t attrs;
+    uint8_t reserved;
+} tte_shm_cell_t;
+
+typedef struct {
+    char magic[4];
+    uint32_t version;
+    uint32_t rows;
+    uint32_t cols;
+    uint32_t slots;
+    uint32_t slot_size;       // Bytes from one slot to the next
+    uint32_t frame_rate;
+    uint32_t flags;           // TTE_SHM_DONE once the animation has ended
+    uint64_t published;       // Frames written; the newest is in slot (published - 1) % slots
+    uint64_t reserved[3];
+} tte_shm_header_t;
+
+#define TTE_SHM_DONE 1
+
+typedef struct {
+    uint64_t seq;             // Odd while the slot is being written
+    uint32_t frame;           // Animation frame the cells show
+    uint32_t reserved;
+    // rows * cols tte_shm_cell_t follow, row by row
+} tte_shm_slot_t;
+
+static inline tte_shm_slot_t *tte_shm_slot(const tte_shm_header_t *shm, uint64_t index) {
+    return (tte_shm_slot_t *)((char *)shm + sizeof(tte_shm_header_t) + (index % shm->slots) * shm->slot_size);
+}
+
+static inline tte_shm_cell_t *tte_shm_cells(tte_shm_slot_t *slot) {
+    return (tte_shm_cell_t *)(slot + 1);
+}
+
+// Copy the newest frame into cells if it is newer than *seen. Returns 1
+// and updates *seen, or 0 if nothing new has been published.
+static inline int tte_shm_read(const tte_shm_header_t *shm, tte_shm_cell_t *cells, uint64_t *seen) {
+    for (;;) {
+        uint64_t published = __atomic_load_n(&shm->published, __ATOMIC_ACQUIRE);
+        if (published == 0 || published == *seen) {
+            return 0;
+        }
+        tte_shm_slot_t *slot = tte_shm_slot(shm, published - 1);
+        uint64_t seq = __atomic_load_n(&slot->seq, __ATOMIC_ACQUIRE);
+        if (seq & 1) {
+            continue;
+        }
+        memcpy(cells, tte_shm_cells(slot), (size_t)shm->rows * shm->cols * sizeof(tte_shm_cell_t));
+        __atomic_thread_fence(__ATOMIC_ACQUIRE);
+        if (__atomic_load_n(&slot->seq, __ATOMIC_RELAXED) == seq) {
+            *seen = published;
+            return 1;
+        }
+    }
+}
+
+#endif
@@ -24,6 +24,31 @@ anchor_t parse_anchor(const char *anchor_str) {
     return ANCHOR_C;
 }
 
+// Command-line names of the easing curves, in easing_t order
+static const char *easing_names[] = {
+    "linear",
+    "in_quad", "out_quad", "in_out_quad",
+    "in_cubic", "out_cubic", "in_out_cubic",
+    "in_quart", "out_quart", "in_out_quart",
+    "in_quint", "out_quint", "in_out_quint",
+    "in_sine", "out_sine", "in_out_sine",
+    "in_expo", "out_expo", "in_out_expo",
+    "in_circ", "out_circ", "in_out_circ",
+    "in_back", "out_back", "in_out_back",
+    "in_elastic", "out_elastic", "in_out_elastic",
+    "in_bounce", "out_bounce", "in_out_bounce"
+};
+
+int parse_easing(const char *easing_str, easing_t *easing) {
+    for (size_t i = 0; i < sizeof(easing_names) / sizeof(easing_names[0]); i++) {
+        if (strcmp(easing_str, easing_names[i]) == 0) {
+            *easing = (easing_t)i;
+            return 1;
+        }
+    }
+    return 0;
+}
+
 void print_usage(const char *program_name) {
     printf("Usage: %s [options] <effect>\n", program_name);
     printf("\nOptions:\n");
@@ -45,6 +70,29 @@ void print_usage(const char *program_name) {
     printf("  --background <effect>     Background effect (stars,matrix,particles,grid,waves,plasma)\n");
     printf("  --background-intensity <n> Background effect intensity (0-100, default: 50)\n");
     printf("  --auto-gradient           Generate random gradient automatically\n");
+    printf("  --threads <n>             Step effects on n threads (default: 1)\n");
+    printf("  --lookahead <n>           Compute up to n frames ahead of the display (default: 8)\n");
+    printf("  --start-frame <n>         Start the animation at frame n\n");
+    printf("  --offline                 Render all frames unpaced, frame ranges split across --threads\n");
+    printf("  --record <file>           Record to an asciicast v2 file instead of the terminal\n");
+    printf("  --record-size <cols>x<rows> Virtual terminal size for --record, --save, --bake and --shm (default: 80x24)\n");
+    printf("  --save <file>             Save the animation as keyframes and frame deltas for --play\n");
+    printf("  --compress                LZ-compress the file written by --save\n");
+    printf("  --play <file>             Play a saved animation without computing any effect\n");
+    printf("  --bake <file.c>           Write the animation as standalone C source with its own player\n");
+    printf("  --sink <backend>          Send output to tty (default), null or memory (count and report only), or file:PATH\n");
+    printf("  --output <tty>[:mode]     Draw on this terminal instead; repeat for up to 16 (mode: no-color, xterm-colors)\n");
+    printf("  --wall <cols>x<rows>      Span one canvas across the --output terminals as a wall of tiles, row by row\n");
+    printf("  --shm <name>              Publish frames as cells in a POSIX shared-memory ring instead of the terminal\n");
+    printf("  --batch <manifest>        Render each INPUT EFFECT OUTPUT [OPTION...] line headless, on all cores\n");
+    printf("  --stats[=json]            Time every frame's stages and report min/median/p99/max on stderr at exit\n");
+    printf("  --stats-file <file>       Write the --stats report to a file instead\n");
+    printf("  --cache                   Replay animations rendered before from $XDG_CACHE_HOME/tte-c\n");
+    printf("  --cache-limit <MiB>       Size the cache is trimmed to, least recently used first (default: 64)\n");
+    printf("  --serve <socket>          Run as a daemon drawing animations for --connect clients\n");
+    printf("  --connect <socket>        Have the daemon draw the animation; runs locally if none answers\n");
+    printf("  --seed <n>                Seed random choices for reproducible runs\n");
+    printf("  --easing <curve>          Motion easing (linear, in_quad, out_cubic, in_out_sine, out_bounce, ...)\n");
     printf("  -h, --help               Show this help message\n");
     printf("\nEffects:\n");
     printf("  beams     Light beams sweep across the text\n");
@@ -76,13 +124,75 @@ void print_usage(const char *program_name) {
     printf("  %s --no-final-newline --anchor-text c beams < input.txt\n", program_name);
 }
 
-void parse_args(int argc, char *argv[], config_t *config) {
+// Defaults for every option, before the command line is parsed
+void init_config(config_t *config) {
+    *config = (config_t){
+        .frame_rate = DEFAULT_FRAME_RATE,
+        .canvas_width = 0,
+        .canvas_height = 0,
+        .no_final_newline = 0,
+        .effect_name = NULL,
+        .anchor_canvas = ANCHOR_C,
+        .anchor_text = ANCHOR_C,
+        .use_gradient = 1,
+        .gradient_direction = GRADIENT_HORIZONTAL,
+        .gradient_angle = 0.0f,
+        .gradient_steps = 64,
+        .gradient_preset = GRADIENT_PRESET_CUSTOM,
+        .background_effect = BACKGROUND_NONE,
+        .background_intensity = 50,
+        .gradient_colors_string = NULL,
+        .auto_gradient = 0,
+        .ignore_terminal_dimensions = 0,
+        .wrap_text = 0,
+        .tab_width = 4,
+        .xterm_colors = 0,
+        .no_color = 0,
+        .easing = EASE_LINEAR,
+        .custom_easing = 0,
+        .seed = DEFAULT_SEED,
+        .custom_seed = 0,
+        .threads = 1,
+        .lookahead = DEFAULT_LOOKAHEAD,
+        .start_frame = 0,
+        .offline = 0,
+        .record_path = NULL,
+        .record_width = DEFAULT_RECORD_WIDTH,
+        .record_height = DEFAULT_RECORD_HEIGHT,
+        .save_path = NULL,
+        .play_path = NULL,
+        .compress = 0,
+        .custom_frame_rate = 0,
+        .cache = 0,
+        .cache_limit = DEFAULT_CACHE_LIMIT,
+        .bake_path = NULL,
+        .serve_path = NULL,
+        .connect_path = NULL,
+        .shm_name = NULL,
+        .sink = NULL,
+        .output_count = 0,
+        .wall_columns = 0,
+        .wall_rows = 0,
+        .batch_path = NULL,
+        .hangup_fd = -1,
+        .stats_format = STATS_OFF,
+        .stats_path = NULL,
+        .stats = NULL
+    };
+}
+
+// Apply the options in argv to config. Returns -1, having said why on
+// stderr, if any of them is invalid.
+int parse_args(int argc, char *argv[], config_t *config) {
+    int status = 0;
     for (int i = 1; i < argc; i++) {
         if (strcmp(argv[i], "--frame-rate") == 0) {
             if (i + 1 < argc) {
                 config->frame_rate = atoi(argv[++i]);
+                config->custom_frame_rate = 1;
                 if (config->frame_rate <= 0) {
                     config->frame_rate = DEFAULT_FRAME_RATE;
+                    config->custom_frame_rate = 0;
                 }
             }
         } else if (strcmp(argv[i], "--canvas-width") == 0) {
@@ -168,59 +278,217 @@ void parse_args(int argc, char *argv[], config_t *config) {
             }
         } else if (strcmp(argv[i], "--auto-gradient") == 0) {
             config->auto_gradient = 1;
+        } else if (strcmp(argv[i], "--threads") == 0) {
+            if (i + 1 < argc) {
+                config->threads = atoi(argv[++i]);
+                if (config->threads < 1) config->threads = 1;
+                if (config->threads > MAX_THREADS) config->threads = MAX_THREADS;
+            }
+        } else if (strcmp(argv[i], "--lookahead") == 0) {
+            if (i + 1 < argc) {
+                config->lookahead = atoi(argv[++i]);
+                if (config->lookahead < 1) config->lookahead = 1;
+                if (config->lookahead > MAX_LOOKAHEAD) config->lookahead = MAX_LOOKAHEAD;
+            }
+        } else if (strcmp(argv[i], "--start-frame") == 0) {
+            if (i + 1 < argc) {
+                config->start_frame = atoi(argv[++i]);
+                if (config->start_frame < 0) config->start_frame = 0;
+                if (config->start_frame > MAX_FRAMES - 1) config->start_frame = MAX_FRAMES - 1;
+            }
+        } else if (strcmp(argv[i], "--offline") == 0) {
+            config->offline = 1;
+        } else if (strcmp(argv[i], "--record") == 0) {
+            if (i + 1 < argc) {
+                config->record_path = argv[++i];
+            }
+        } else if (strcmp(argv[i], "--save") == 0) {
+            if (i + 1 < argc) {
+                config->save_path = argv[++i];
+            }
+        } else if (strcmp(argv[i], "--play") == 0) {
+            if (i + 1 < argc) {
+                config->play_path = argv[++i];
+            }
+        } else if (strcmp(argv[i], "--compress") == 0) {
+            config->compress = 1;
+        } else if (strcmp(argv[i], "--bake") == 0) {
+            if (i + 1 < argc) {
+                config->bake_path = argv[++i];
+            }
+        } else if (strcmp(argv[i], "--serve") == 0) {
+            if (i + 1 < argc) {
+                config->serve_path = argv[++i];
+            }
+        } else if (strcmp(argv[i], "--connect") == 0) {
+            if (i + 1 < argc) {
+                config->connect_path = argv[++i];
+            }
+        } else if (strcmp(argv[i], "--shm") == 0) {
+            if (i + 1 < argc) {
+                config->shm_name = argv[++i];
+            }
+        } else if (strcmp(argv[i], "--sink") == 0) {
+            if (i + 1 < argc) {
+                config->sink = argv[++i];
+            }
+        } else if (strcmp(argv[i], "--output") == 0) {
+            if (i + 1 < argc) {
+                if (config->output_count < MAX_OUTPUTS) {
+                    config->outputs[config->output_count++] = argv[i + 1];
+                } else {
+                    fprintf(stderr, "Too many --output targets, ignoring %s\n", argv[i + 1]);
+                }
+                i++;
+            }
+        } else if (strcmp(argv[i], "--wall") == 0) {
+            if (i + 1 < argc) {
+                int columns = 0, rows = 0;
+                char end;
+                // Each side is bounded before multiplying so the product cannot overflow
+                if (sscanf(argv[++i], "%dx%d%c", &columns, &rows, &end) == 2 && columns > 0 && rows > 0 &&
+                    columns <= MAX_OUTPUTS && rows <= MAX_OUTPUTS && columns * rows <= MAX_OUTPUTS) {
+                    config->wall_columns = columns;
+                    config->wall_rows = rows;
+                } else {
+                    fprintf(stderr, "Invalid --wall %s: expected CxR with at most %d tiles\n", argv[i], MAX_OUTPUTS);
+                    status = -1;
+                }
+            }
+        } else if (strcmp(argv[i], "--batch") == 0) {
+            if (i + 1 < argc) {
+                config->batch_path = argv[++i];
+            }
+        } else if (strcmp(argv[i], "--stats") == 0 || strcmp(argv[i], "--stats=text") == 0) {
+            config->stats_format = STATS_TEXT;
+        } else if (strcmp(argv[i], "--stats=json") == 0) {
+            config->stats_format = STATS_JSON;
+        } else if (strcmp(argv[i], "--stats-file") == 0) {
+            if (i + 1 < argc) {
+                config->stats_path = argv[++i];
+                if (config->stats_format == STATS_OFF) {
+                    config->stats_format = STATS_TEXT;
+                }
+            }
+        } else if (strcmp(argv[i], "--cache") == 0) {
+            config->cache = 1;
+        } else if (strcmp(argv[i], "--cache-limit") == 0) {
+            if (i + 1 < argc) {
+                long long megabytes = atoll(argv[++i]);
+                config->cache_limit = (megabytes > 0 ? megabytes : 1) << 20;
+            }
+        } else if (strcmp(argv[i], "--record-size") == 0) {
+            if (i + 1 < argc) {
+                int width = 0, height = 0;
+                if (sscanf(argv[++i], "%dx%d", &width, &height) == 2 && width > 0 && height > 0) {
+                    config->record_width = width < MAX_COLS ? width : MAX_COLS;
+                    config->record_height = height < MAX_LINES ? height : MAX_LINES;
+                }
+            }
+        } else if (strcmp(argv[i], "--seed") == 0) {
+            if (i + 1 < argc) {
+                config->seed = (unsigned int)strtoul(argv[++i], NULL, 10);
+                config->custom_seed = 1;
+            }
+        } else if (strcmp(argv[i], "--easing") == 0) {
+            if (i + 1 < argc) {
+                config->custom_easing = parse_easing(argv[++i], &config->easing);
+                if (!config->custom_easing) {
+                    fprintf(stderr, "Unknown easing: %s\n", argv[i]);
+                    status = -1;
+                }
+            }
         } else if (strcmp(argv[i], "-h") == 0 || strcmp(argv[i], "--help") == 0) {
             print_usage(argv[0]);
             exit(0);
         } else if (argv[i][0] != '-') {
             // This is the effect name
             config->effect_name = argv[i];
+        } else {
+            fprintf(stderr, "Unknown option: %s\n", argv[i]);
+            status = -1;
         }
     }
+    return status;
 }
 
-effect_func_t get_effect_function(const char *effect_name) {
-    if (strcmp(effect_name, "beams") == 0) {
-        return effect_beams;
-    } else if (strcmp(effect_name, "waves") == 0) {
-        return effect_waves;
-    } else if (strcmp(effect_name, "rain") == 0) {
-        return effect_rain;
-    } else if (strcmp(effect_name, "slide") == 0) {
-        return effect_slide;
-    } else if (strcmp(effect_name, "expand") == 0) {
-        return effect_expand;
-    } else if (strcmp(effect_name, "matrix") == 0) {
-        return effect_matrix;
-    } else if (strcmp(effect_name, "fireworks") == 0) {
-        return effect_fireworks;
-    } else if (strcmp(effect_name, "decrypt") == 0) {
-        return effect_decrypt;
-    } else if (strcmp(effect_name, "typewriter") == 0) {
-        return effect_typewriter;
-    } else if (strcmp(effect_name, "wipe") == 0) {
-        return effect_wipe;
-    } else if (strcmp(effect_name, "spotlights") == 0) {
-        return effect_spotlights;
-    } else if (strcmp(effect_name, "burn") == 0) {
-        return effect_burn;
-    } else if (strcmp(effect_name, "swarm") == 0) {
-        return effect_swarm;
-    } else if (strcmp(effect_name, "highlight") == 0) {
-        return effect_highlight;
-    } else if (strcmp(effect_name, "unstable") == 0) {
-        return effect_unstable;
-    } else if (strcmp(effect_name, "crumble") == 0) {
-        return effect_crumble;
-    } else if (strcmp(effect_name, "slice") == 0) {
-        return effect_slice;
-    } else if (strcmp(effect_name, "pour") == 0) {
-        return effect_pour;
-    } else if (strcmp(effect_name, "blackhole") == 0) {
-        return effect_blackhole;
-    } else if (strcmp(effect_name, "rings") == 0) {
-        return effect_rings;
-    } else if (strcmp(effect_name, "synthgrid") == 0) {
-        return effect_synthgrid;
+// Every effect and how it may be stepped. Reveal-timeline effects keep a
+// shared queue, so they always step on one thread.
+static const effect_info_t effect_table[] = {
+    {"beams", effect_beams, EFFECT_PARALLEL},
+    {"waves", effect_waves, EFFECT_PARALLEL},
+    {"rain", effect_rain, 0},
+    {"slide", effect_slide, EFFECT_PARALLEL},
+    {"expand", effect_expand, EFFECT_PARALLEL},
+    {"matrix", effect_matrix, EFFECT_PARALLEL},
+    {"fireworks", effect_fireworks, EFFECT_PARALLEL},
+    {"decrypt", effect_decrypt, 0},
+    {"typewriter", effect_typewriter, 0},
+    {"wipe", effect_wipe, 0},
+    {"spotlights", effect_spotlights, EFFECT_PARALLEL},
+    {"burn", effect_burn, 0},
+    {"swarm", effect_swarm, EFFECT_PARALLEL},
+    {"highlight", effect_highlight, EFFECT_PARALLEL},
+    {"unstable", effect_unstable, EFFECT_PARALLEL},
+    {"crumble", effect_crumble, EFFECT_PARALLEL},
+    {"slice", effect_slice, EFFECT_PARALLEL},
+    {"pour", effect_pour, EFFECT_PARALLEL},
+    {"blackhole", effect_blackhole, EFFECT_PARALLEL},
+    {"rings", effect_rings, EFFECT_PARALLEL},
+    {"synthgrid", effect_synthgrid, EFFECT_PARALLEL}
+};
+
+const effect_info_t *find_effect(const char *effect_name) {
+    for (size_t i = 0; i < sizeof(effect_table) / sizeof(effect_table[0]); i++) {
+        if (strcmp(effect_name, effect_table[i].name) == 0) {
+            return &effect_table[i];
+        }
     }
     return NULL;
 }
+
+effect_func_t get_effect_function(const char *effect_name) {
+    const effect_info_t *info = find_effect(effect_name);
+    return info ? info->func : NULL;
+}
+
+// Easing an effect uses unless --easing overrides it
+easing_t get_effect_easing(const char *effect_name) {
+    if (strcmp(effect_name, "unstable") == 0 || strcmp(effect_name, "blackhole") == 0) {
+        return EASE_OUT_CUBIC;
+    }
+    return EASE_LINEAR;
+}
+
+void buffer_append(byte_buffer_t *buf, const char *data, size_t len) {
+    if (buf->len + len > buf->cap) {
+        size_t new_cap = buf->cap ? buf->cap * 2 : 65536;
+        while (new_cap < buf->len + len) {
+            new_cap *= 2;
+        }
+        char *new_data = realloc(buf->data, new_cap);
+        if (!new_data) {
+            return;  // Drop output rather than crash mid-animation
+        }
+        buf->data = new_data;
+        buf->cap = new_cap;
+    }
+    memcpy(buf->data + buf->len, data, len);
+    buf->len += len;
+}
+
+// Append everything left in file
+void buffer_read_file(byte_buffer_t *buf, FILE *file) {
+    char chunk[4096];
+    size_t len;
+    while ((len = fread(chunk, 1, sizeof(chunk), file)) > 0) {
+        buffer_append(buf, chunk, len);
+    }
+}
+
+void buffer_free(byte_buffer_t *buf) {
+    free(buf->data);
+    buf->data = NULL;
+    buf->len = 0;
+    buf->cap = 0;
+}
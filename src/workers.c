@@ -0,0 +1,170 @@
+#include "tte.h"
+
+typedef struct {
+    worker_pool_t *pool;
+    int index;
+} worker_arg_t;
+
+static void *worker_main(void *arg) {
+    worker_arg_t *wa = arg;
+    worker_pool_t *pool = wa->pool;
+    int index = wa->index;
+    int seen = 0;
+    free(wa);
+
+    for (;;) {
+        pthread_mutex_lock(&pool->lock);
+        while (pool->generation == seen && !pool->shutdown) {
+            pthread_cond_wait(&pool->start, &pool->lock);
+        }
+        if (pool->shutdown) {
+            pthread_mutex_unlock(&pool->lock);
+            return NULL;
+        }
+        seen = pool->generation;
+        pthread_mutex_unlock(&pool->lock);
+
+        pool->job(pool->job_ctx, index);
+
+        pthread_mutex_lock(&pool->lock);
+        if (--pool->pending == 0) {
+            pthread_cond_signal(&pool->done);
+        }
+        pthread_mutex_unlock(&pool->lock);
+    }
+}
+
+// Start threads - 1 workers; the calling thread steps the first range itself
+worker_pool_t *worker_pool_create(int threads) {
+    if (threads < 2) {
+        return NULL;
+    }
+    if (threads > MAX_THREADS) {
+        threads = MAX_THREADS;
+    }
+
+    worker_pool_t *pool = calloc(1, sizeof(worker_pool_t));
+    if (!pool) {
+        return NULL;
+    }
+    pool->threads = calloc(threads, sizeof(pthread_t));
+    pool->views = calloc(threads, sizeof(terminal_t));
+    if (!pool->threads || !pool->views) {
+        free(pool->threads);
+        free(pool->views);
+        free(pool);
+        return NULL;
+    }
+    pthread_mutex_init(&pool->lock, NULL);
+    pthread_mutex_init(&pool->run_lock, NULL);
+    pthread_cond_init(&pool->start, NULL);
+    pthread_cond_init(&pool->done, NULL);
+
+    pool->count = 1;
+    for (int i = 1; i < threads; i++) {
+        worker_arg_t *wa = malloc(sizeof(worker_arg_t));
+        if (!wa) {
+            break;
+        }
+        wa->pool = pool;
+        wa->index = i;
+        if (pthread_create(&pool->threads[i], NULL, worker_main, wa) != 0) {
+            free(wa);
+            break;
+        }
+        pool->count++;
+    }
+    return pool;
+}
+
+// Point each view at its slice of the characters. Views share everything
+// read-only with the terminal but keep their own sweep and lane scratch.
+// Slices start on phasor resync boundaries so incremental trig matches a
+// single-threaded walk bit for bit.
+static void prepare_views(worker_pool_t *pool, terminal_t *term) {
+    int per_worker = (term->char_count + pool->count - 1) / pool->count;
+    per_worker = (per_worker + PHASOR_RESYNC - 1) / PHASOR_RESYNC * PHASOR_RESYNC;
+    for (int w = 0; w < pool->count; w++) {
+        terminal_t *view = &pool->views[w];
+        sweep_mask_t *sweep = view->sweep;
+        lane_table_t *lanes = view->lanes;
+
+        int begin = w * per_worker;
+        int end = begin + per_worker;
+        if (begin > term->char_count) begin = term->char_count;
+        if (end > term->char_count) end = term->char_count;
+
+        *view = *term;
+        view->chars = term->chars + begin;
+        view->char_count = end - begin;
+        view->char_base = term->char_base + begin;
+        view->fb = NULL;
+        view->timeline = NULL;
+        view->damage = NULL;
+        view->damage_valid = 0;
+        view->sweep = sweep;
+        view->lanes = lanes;
+    }
+}
+
+// Run job(ctx, worker) once on every worker, the calling thread being
+// worker 0, and wait for all of them to finish. Jobs from different
+// threads (stepping and pipelined encoding) take turns.
+void worker_pool_run(worker_pool_t *pool, worker_job_t job, void *ctx) {
+    pthread_mutex_lock(&pool->run_lock);
+    pthread_mutex_lock(&pool->lock);
+    pool->job = job;
+    pool->job_ctx = ctx;
+    pool->pending = pool->count - 1;
+    pool->generation++;
+    pthread_cond_broadcast(&pool->start);
+    pthread_mutex_unlock(&pool->lock);
+
+    job(ctx, 0);
+
+    pthread_mutex_lock(&pool->lock);
+    while (pool->pending > 0) {
+        pthread_cond_wait(&pool->done, &pool->lock);
+    }
+    pthread_mutex_unlock(&pool->lock);
+    pthread_mutex_unlock(&pool->run_lock);
+}
+
+// Step one worker's character range for the current frame
+static void step_view(void *ctx, int worker) {
+    worker_pool_t *pool = ctx;
+    pool->func(&pool->views[worker], pool->frame);
+}
+
+// Step every character of the frame across the pool
+void worker_pool_step(worker_pool_t *pool, terminal_t *term, effect_func_t func, int frame) {
+    prepare_views(pool, term);
+    pool->func = func;
+    pool->frame = frame;
+    worker_pool_run(pool, step_view, pool);
+}
+
+void worker_pool_destroy(worker_pool_t *pool) {
+    if (!pool) {
+        return;
+    }
+    pthread_mutex_lock(&pool->lock);
+    pool->shutdown = 1;
+    pthread_cond_broadcast(&pool->start);
+    pthread_mutex_unlock(&pool->lock);
+
+    for (int i = 1; i < pool->count; i++) {
+        pthread_join(pool->threads[i], NULL);
+    }
+    for (int w = 0; w < pool->count; w++) {
+        free_sweep_mask(&pool->views[w]);
+        free_lane_table(&pool->views[w]);
+    }
+    pthread_mutex_destroy(&pool->lock);
+    pthread_mutex_destroy(&pool->run_lock);
+    pthread_cond_destroy(&pool->start);
+    pthread_cond_destroy(&pool->done);
+    free(pool->threads);
+    free(pool->views);
+    free(pool);
+}
@@ -8,6 +8,7 @@
 #include <sys/time.h>
 #include <stdbool.h>
 #include "../src/tte.h"
+#include "../src/libtte.h"
 
 // Simple test framework
 #define TEST(name) void test_##name()
@@ -752,6 +753,1530 @@ TEST(background_rendering_safety) {
     cleanup_terminal(&term);
 }
 
+// Test dirty-tile tracking
+TEST(dirty_tile_tracking) {
+    terminal_t term = {0};
+    init_terminal(&term);
+    term.terminal_width = 80;
+    term.terminal_height = 24;
+    
+    // Two characters in different tiles
+    term.char_count = 2;
+    for (int i = 0; i < 2; i++) {
+        term.chars[i].ch = 'A' + i;
+        term.chars[i].target.row = 0;
+        term.chars[i].target.col = i * 40;
+        term.chars[i].pos = term.chars[i].target;
+        term.chars[i].visible = 1;
+        term.chars[i].active = 0;
+        term.chars[i].color_fg = 15;
+        term.chars[i].color_bg = -1;
+    }
+    
+    // First frame redraws everything
+    assert(update_tile_state(&term) == 0);
+    track_dirty_tiles(&term, NULL);
+    assert(tile_is_dirty(&term, 0, 0));
+    assert(tile_is_dirty(&term, 23, 79));
+    
+    // Unchanged frame leaves every tile clean, with nothing active
+    track_dirty_tiles(&term, NULL);
+    assert(!tile_is_dirty(&term, 0, 0));
+    assert(!tile_is_dirty(&term, 0, 40));
+    assert(!(term.fb->tiles[0][0] & TILE_ACTIVE));
+    
+    // Moving a character dirties both its old and new tile only
+    term.chars[0].pos.row = 10;
+    term.chars[0].active = 1;
+    assert(update_tile_state(&term) == 1);
+    track_dirty_tiles(&term, NULL);
+    assert(tile_is_dirty(&term, 0, 0));
+    assert(tile_is_dirty(&term, 10, 0));
+    assert(!tile_is_dirty(&term, 0, 40));
+    assert(term.fb->tiles[10 / TILE_HEIGHT][0] & TILE_ACTIVE);
+    
+    cleanup_terminal(&term);
+    assert(term.fb == NULL);
+}
+
+TEST(reveal_timeline_queue) {
+    terminal_t term = {0};
+    init_terminal(&term);
+    term.text_width = 10;
+    term.text_height = 1;
+    
+    // One row of ten characters revealed two per frame
+    term.char_count = 10;
+    for (int i = 0; i < 10; i++) {
+        term.chars[i].ch = 'a' + i;
+        term.chars[i].target.row = 0;
+        term.chars[i].target.col = i;
+        term.chars[i].active = 1;
+    }
+    
+    // Frame 0 starts only the first two characters
+    effect_typewriter(&term, 0);
+    assert(term.damage_valid);
+    assert(term.damage_count == 2);
+    assert(term.chars[1].visible && !term.chars[2].visible);
+    assert(update_tile_state(&term) == 8);
+    
+    // Frame 3 steps the newly started pair plus the still-bright ones
+    effect_typewriter(&term, 1);
+    effect_typewriter(&term, 2);
+    effect_typewriter(&term, 3);
+    assert(term.chars[7].visible && !term.chars[8].visible);
+    assert(term.damage_count == 8);
+    assert(!term.chars[0].bold && term.chars[6].bold);
+    assert(update_tile_state(&term) == 2);
+    
+    // Stepping backwards replays from the start
+    effect_typewriter(&term, 0);
+    assert(term.damage_count == 2);
+    
+    cleanup_terminal(&term);
+    assert(term.timeline == NULL);
+}
+
+TEST(sweep_mask_primitives) {
+    terminal_t term = {0};
+    init_terminal(&term);
+    term.text_width = 100;
+    term.text_height = 10;
+    
+    sweep_mask_t *mask = sweep_begin(&term);
+    assert(mask != NULL);
+    assert(mask->words == 2);
+    
+    // Column band crossing the word boundary, limited to rows 2..3
+    sweep_band(mask, SWEEP_COLS, 64.0f, 2.0f, 2, 3);
+    assert(sweep_highlighted(mask, 2, 62) && sweep_highlighted(mask, 3, 66));
+    assert(!sweep_highlighted(mask, 2, 61) && !sweep_highlighted(mask, 2, 67));
+    assert(sweep_revealed(mask, 2, 0) && !sweep_revealed(mask, 2, 67));
+    assert(!sweep_revealed(mask, 4, 10));
+    
+    // Diagonal band follows col - row
+    mask = sweep_begin(&term);
+    sweep_band(mask, SWEEP_DIAG_DOWN, 10.0f, 0.0f, 0, 0);
+    assert(sweep_highlighted(mask, 0, 10) && sweep_highlighted(mask, 5, 15));
+    assert(!sweep_highlighted(mask, 5, 10) && sweep_revealed(mask, 5, 10));
+    
+    // Ring edge is highlighted, its inside revealed, outside untouched
+    mask = sweep_begin(&term);
+    sweep_ring(mask, 5, 50, 4.0f, 1.0f);
+    assert(sweep_highlighted(mask, 5, 54) && sweep_highlighted(mask, 5, 46));
+    assert(!sweep_highlighted(mask, 5, 50) && sweep_revealed(mask, 5, 50));
+    assert(!sweep_revealed(mask, 5, 56));
+    
+    // Circle covers its whole disk; cells past the grid never read as set
+    sweep_circle(mask, 5, 99, 3.0f);
+    assert(sweep_highlighted(mask, 5, 99) && sweep_highlighted(mask, 3, 98));
+    assert(!sweep_highlighted(mask, 5, 100));
+    
+    cleanup_terminal(&term);
+    assert(term.sweep == NULL);
+}
+
+TEST(lane_state_tables) {
+    terminal_t term = {0};
+    init_terminal(&term);
+    term.text_width = 4;
+    term.text_height = 2;
+    
+    // Wrapped character past the measured width still gets a lane
+    term.char_count = 2;
+    term.chars[0].target.row = 0;
+    term.chars[0].target.col = 0;
+    term.chars[1].target.row = 1;
+    term.chars[1].target.col = 6;
+    for (int i = 0; i < 2; i++) {
+        term.chars[i].ch = 'x';
+        term.chars[i].pos = term.chars[i].target;
+        term.chars[i].active = 1;
+    }
+    lane_table_t *lanes = lanes_begin(&term);
+    assert(lanes != NULL);
+    assert(lanes->width == 7 && lanes->height == 2);
+    assert(lanes_begin(&term) == lanes);
+    
+    // Slide: row 1 starts five frames after row 0
+    effect_slide(&term, 2);
+    assert(lanes->rows[0].phase == LANE_RUNNING);
+    assert(lanes->rows[0].head == -term.text_width + 4);
+    assert(lanes->rows[1].phase == LANE_WAITING);
+    assert(!term.chars[0].active && term.chars[1].active);
+    
+    cleanup_terminal(&term);
+    assert(term.lanes == NULL);
+}
+
+TEST(fast_trig_accuracy) {
+    // Polynomial sine/cosine stay well inside a cell's resolution
+    for (float x = -200.0f; x < 200.0f; x += 0.173f) {
+        float s, c;
+        fast_sincosf(x, &s, &c);
+        assert(fabs(s - sin(x)) < 1e-5);
+        assert(fabs(c - cos(x)) < 1e-5);
+    }
+    assert(fabs(fast_sqrtf(2.0f) - sqrt(2.0)) < 1e-6);
+    
+    // Phasor rotation tracks the directly computed angle over long runs
+    phasor_t p;
+    phasor_init(&p, 1.0f, 0.3f);
+    for (int n = 0; n < 2000; n++, phasor_next(&p)) {
+        assert(fabs(p.s - sin(1.0 + n * 0.3)) < 1e-3);
+        assert(fabs(p.c - cos(1.0 + n * 0.3)) < 1e-3);
+    }
+}
+
+TEST(easing_lut_lookup) {
+    easing_lut_t lut;
+    
+    // Every curve's table tracks the exact function closely
+    for (int e = EASE_LINEAR; e <= EASE_IN_OUT_BOUNCE; e++) {
+        build_easing_lut(&lut, (easing_t)e);
+        for (float t = 0.0f; t <= 1.0f; t += 0.0137f) {
+            assert(fabs(easing_lookup(&lut, t) - apply_easing(t, (easing_t)e)) < 1e-3);
+        }
+        assert(easing_lookup(&lut, -1.0f) == 0.0f);
+        assert(easing_lookup(&lut, 2.0f) == 1.0f);
+    }
+    
+    // Names map onto curves; unknown names are rejected
+    easing_t easing = EASE_LINEAR;
+    assert(parse_easing("out_cubic", &easing) && easing == EASE_OUT_CUBIC);
+    assert(parse_easing("in_out_bounce", &easing) && easing == EASE_IN_OUT_BOUNCE);
+    assert(!parse_easing("wobbly", &easing) && easing == EASE_IN_OUT_BOUNCE);
+    config_t config;
+    init_config(&config);
+    char *argv[] = {"tte-c", "--easing", "wobbly", "slide"};
+    assert(parse_args(4, argv, &config) != 0 && !config.custom_easing);
+    
+    // The bounce segments meet where they hand over
+    assert(fabs(ease_out_bounce(1.0f / 2.75f) - 1.0f) < 1e-4);
+    assert(fabs(ease_out_bounce(1.0f) - 1.0f) < 1e-4);
+    assert(get_effect_easing("blackhole") == EASE_OUT_CUBIC);
+    assert(get_effect_easing("expand") == EASE_LINEAR);
+}
+
+TEST(counter_based_random) {
+    // Values are pure functions of their inputs
+    assert(random_u32(7, RANDOM_STREAM_BURN, 3, 10) == random_u32(7, RANDOM_STREAM_BURN, 3, 10));
+    assert(random_u32(7, RANDOM_STREAM_BURN, 3, 10) != random_u32(8, RANDOM_STREAM_BURN, 3, 10));
+    assert(random_u32(7, RANDOM_STREAM_BURN, 3, 10) != random_u32(7, RANDOM_STREAM_DECRYPT, 3, 10));
+    
+    // Ranges are respected and roughly uniform
+    int counts[5] = {0};
+    for (int i = 0; i < 5000; i++) {
+        int r = random_range(1, RANDOM_STREAM_CRUMBLE, i, 0, 5);
+        assert(r >= 0 && r < 5);
+        counts[r]++;
+    }
+    for (int k = 0; k < 5; k++) {
+        assert(counts[k] > 800 && counts[k] < 1200);
+    }
+    
+    // Auto gradients are reproducible from the seed
+    config_t a = {0}, b = {0};
+    generate_auto_gradient(&a, 42);
+    generate_auto_gradient(&b, 42);
+    assert(a.gradient_direction == b.gradient_direction);
+    assert(a.gradient_count == b.gradient_count);
+    assert(memcmp(a.gradient_stops, b.gradient_stops, sizeof(a.gradient_stops)) == 0);
+}
+
+TEST(worker_pool_matches_serial) {
+    terminal_t serial = {0}, parallel = {0};
+    init_terminal(&serial);
+    init_terminal(&parallel);
+    
+    // Enough characters to give every worker a few resync blocks
+    int count = 1000;
+    for (terminal_t *t = &serial; t; t = (t == &serial) ? &parallel : NULL) {
+        t->text_width = 50;
+        t->text_height = 20;
+        t->char_count = count;
+        for (int i = 0; i < count; i++) {
+            t->chars[i].ch = 'a' + i % 26;
+            t->chars[i].target.row = i / 50;
+            t->chars[i].target.col = i % 50;
+            t->chars[i].pos = t->chars[i].target;
+            t->chars[i].active = 1;
+        }
+    }
+    
+    worker_pool_t *pool = worker_pool_create(3);
+    assert(pool != NULL);
+    effect_func_t effects[] = {effect_blackhole, effect_crumble, effect_rings, effect_matrix};
+    for (int e = 0; e < 4; e++) {
+        for (int frame = 0; frame < 120; frame += 7) {
+            effects[e](&serial, frame);
+            worker_pool_step(pool, &parallel, effects[e], frame);
+            for (int i = 0; i < count; i++) {
+                assert(serial.chars[i].pos.row == parallel.chars[i].pos.row);
+                assert(serial.chars[i].pos.col == parallel.chars[i].pos.col);
+                assert(serial.chars[i].visible == parallel.chars[i].visible);
+                assert(serial.chars[i].bold == parallel.chars[i].bold);
+                assert(serial.chars[i].ch == parallel.chars[i].ch);
+            }
+        }
+    }
+    assert(find_effect("blackhole")->flags & EFFECT_PARALLEL);
+    assert(!(find_effect("typewriter")->flags & EFFECT_PARALLEL));
+    
+    worker_pool_destroy(pool);
+    cleanup_terminal(&serial);
+    cleanup_terminal(&parallel);
+}
+
+// Render one frame with stdout redirected to a temporary file
+static size_t capture_output(terminal_t *term, config_t *config, char *buf, size_t size) {
+    FILE *capture = tmpfile();
+    assert(capture != NULL);
+    fflush(stdout);
+    int saved = dup(STDOUT_FILENO);
+    dup2(fileno(capture), STDOUT_FILENO);
+    render_frame_with_config(term, config);
+    dup2(saved, STDOUT_FILENO);
+    close(saved);
+    rewind(capture);
+    size_t len = fread(buf, 1, size, capture);
+    fclose(capture);
+    return len;
+}
+
+// Test that row bands encoded on worker threads match the serial encoder
+TEST(banded_encoding_matches_serial) {
+    config_t config = {0};
+    terminal_t serial = {0}, banded = {0};
+    init_terminal(&serial);
+    init_terminal(&banded);
+    
+    for (terminal_t *t = &serial; t; t = (t == &serial) ? &banded : NULL) {
+        t->terminal_width = 80;
+        t->terminal_height = 24;
+        t->char_count = 80 * 20;
+        for (int i = 0; i < t->char_count; i++) {
+            t->chars[i].ch = 'a' + i % 26;
+            t->chars[i].target.row = i / 80;
+            t->chars[i].target.col = i % 80;
+            t->chars[i].pos = t->chars[i].target;
+            t->chars[i].visible = 1;
+            t->chars[i].color_fg = 16 + i % 200;
+            t->chars[i].color_bg = -1;
+            t->chars[i].bold = (i % 7) == 0;
+        }
+    }
+    
+    worker_pool_t *pool = worker_pool_create(3);
+    assert(pool != NULL);
+    banded.pool = pool;
+    
+    static char a[1 << 16], b[1 << 16];
+    for (int frame = 0; frame < 3; frame++) {
+        size_t la = capture_output(&serial, &config, a, sizeof(a));
+        size_t lb = capture_output(&banded, &config, b, sizeof(b));
+        assert(la > 0 && la == lb);
+        assert(memcmp(a, b, la) == 0);
+        assert(banded.fb->frame.band_count == 3);
+        // Move a few characters so later frames only redraw dirty runs
+        for (int i = 0; i < 80 * 20; i += 37) {
+            serial.chars[i].pos.row = (serial.chars[i].pos.row + 5) % 20;
+            banded.chars[i].pos.row = serial.chars[i].pos.row;
+        }
+    }
+    
+    banded.pool = NULL;
+    worker_pool_destroy(pool);
+    cleanup_terminal(&serial);
+    cleanup_terminal(&banded);
+}
+
+// Test that the threaded composite/encode/write pipeline emits the same
+// bytes in the same order as rendering each frame inline
+TEST(frame_pipeline_matches_direct) {
+    config_t config = {0};
+    terminal_t direct = {0}, piped = {0};
+    init_terminal(&direct);
+    init_terminal(&piped);
+    
+    for (terminal_t *t = &direct; t; t = (t == &direct) ? &piped : NULL) {
+        t->terminal_width = 80;
+        t->terminal_height = 24;
+        t->char_count = 400;
+        for (int i = 0; i < t->char_count; i++) {
+            t->chars[i].ch = 'A' + i % 26;
+            t->chars[i].target.row = i / 40;
+            t->chars[i].target.col = i % 40;
+            t->chars[i].pos = t->chars[i].target;
+            t->chars[i].visible = 1;
+            t->chars[i].color_fg = 16 + i % 200;
+            t->chars[i].color_bg = -1;
+        }
+    }
+    
+    static char expected[1 << 18], actual[1 << 18];
+    FILE *capture = tmpfile();
+    assert(capture != NULL);
+    output_t out;
+    output_init_tty(&out, fileno(capture));
+    frame_pipeline_t *pipeline = frame_pipeline_create(&config, NULL, &out, 3);
+    assert(pipeline != NULL);
+    
+    size_t expected_len = 0;
+    for (int frame = 0; frame < 20; frame++) {
+        expected_len += capture_output(&direct, &config, expected + expected_len,
+                                       sizeof(expected) - expected_len);
+        frame_pipeline_submit(pipeline, &piped);
+        // Slide one character per frame so every frame has a little damage
+        int i = (frame * 13) % 400;
+        direct.chars[i].pos.col = (direct.chars[i].pos.col + 41) % 80;
+        piped.chars[i].pos.col = direct.chars[i].pos.col;
+    }
+    frame_pipeline_drain(pipeline);
+    assert(pipeline->written == pipeline->composited);
+    frame_pipeline_destroy(pipeline);
+    
+    rewind(capture);
+    size_t actual_len = fread(actual, 1, sizeof(actual), capture);
+    fclose(capture);
+    assert(actual_len == expected_len);
+    assert(memcmp(expected, actual, actual_len) == 0);
+    
+    cleanup_terminal(&direct);
+    cleanup_terminal(&piped);
+}
+
+static double elapsed_since(struct timespec *start) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (now.tv_sec - start->tv_sec) + (now.tv_nsec - start->tv_nsec) / 1e9;
+}
+
+// Test that the I/O thread paces frames while the caller runs ahead
+TEST(frame_lookahead_pacing) {
+    config_t config = {0};
+    config.frame_rate = 100;
+    terminal_t term = {0};
+    init_terminal(&term);
+    term.terminal_width = 40;
+    term.terminal_height = 10;
+    term.char_count = 40;
+    for (int i = 0; i < term.char_count; i++) {
+        term.chars[i].ch = 'a' + i % 26;
+        term.chars[i].target.col = i;
+        term.chars[i].pos = term.chars[i].target;
+        term.chars[i].visible = 1;
+        term.chars[i].color_fg = 46;
+        term.chars[i].color_bg = -1;
+    }
+    
+    FILE *sink = tmpfile();
+    assert(sink != NULL);
+    struct timespec start;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    output_t out;
+    output_init_tty(&out, fileno(sink));
+    frame_pipeline_t *pipeline = frame_pipeline_create(&config, NULL, &out, 9);
+    assert(pipeline != NULL);
+    
+    // Nine changing frames fit in the ring, so submitting never waits on
+    // the 10ms frame deadlines
+    for (int frame = 0; frame < 9; frame++) {
+        term.frame_count = frame;
+        term.chars[frame].pos.row = 5;
+        frame_pipeline_submit(pipeline, &term);
+    }
+    double submitted = elapsed_since(&start);
+    frame_pipeline_drain(pipeline);
+    double drained = elapsed_since(&start);
+    frame_pipeline_destroy(pipeline);
+    fclose(sink);
+    
+    // Frame 8 cannot go out before its deadline 80ms in
+    assert(drained >= 0.079);
+    assert(submitted < 0.05 && submitted < drained);
+    
+    cleanup_terminal(&term);
+}
+
+// Lay out a block of text whose characters start hidden at their targets
+static void setup_seek_text(terminal_t *t) {
+    t->terminal_width = 80;
+    t->terminal_height = 24;
+    t->text_width = 48;
+    t->text_height = 12;
+    t->char_count = 48 * 12;
+    t->seed = 7;
+    for (int i = 0; i < t->char_count; i++) {
+        character_t *ch = &t->chars[i];
+        ch->ch = ch->original_ch = 'a' + i % 26;
+        ch->target.row = i / 48;
+        ch->target.col = i % 48;
+        ch->pos = ch->target;
+        ch->visible = 0;
+        ch->active = 1;
+        ch->color_fg = 16 + i % 200;
+        ch->color_bg = -1;
+    }
+}
+
+// Test that every effect seeks straight to a frame with the same result
+// as stepping through all the frames before it
+TEST(seek_matches_stepping) {
+    const char *effects[] = {
+        "beams", "waves", "rain", "slide", "expand", 
+        "matrix", "fireworks", "decrypt", "typewriter", 
+        "wipe", "spotlights", "burn", "swarm",
+        "highlight", "unstable", "crumble", "slice",
+        "pour", "blackhole", "rings", "synthgrid"
+    };
+    int targets[] = {3, 41, 97, 163, 231};
+    
+    for (int e = 0; e < 21; e++) {
+        effect_func_t func = get_effect_function(effects[e]);
+        terminal_t stepped = {0}, seeked = {0};
+        init_terminal(&stepped);
+        init_terminal(&seeked);
+        setup_seek_text(&stepped);
+        setup_seek_text(&seeked);
+        save_initial_state(&seeked);
+        
+        int frame = 0;
+        for (int t = 0; t < 5; t++) {
+            for (; frame <= targets[t]; frame++) {
+                stepped.frame_count = frame;
+                func(&stepped, frame);
+            }
+            seek_effect(&seeked, func, targets[t]);
+            for (int i = 0; i < stepped.char_count; i++) {
+                character_t *a = &stepped.chars[i], *b = &seeked.chars[i];
+                assert(a->ch == b->ch);
+                assert(a->pos.row == b->pos.row && a->pos.col == b->pos.col);
+                assert(a->visible == b->visible);
+                assert(a->active == b->active);
+                assert(a->bold == b->bold);
+                assert(a->color_fg == b->color_fg);
+            }
+        }
+        
+        cleanup_terminal(&stepped);
+        cleanup_terminal(&seeked);
+        assert(seeked.initial == NULL);
+    }
+}
+
+static byte_buffer_t offline_capture;
+
+static void collect_output(void *ctx, int frame, const char *data, size_t len) {
+    int *last = ctx;
+    assert(frame > *last);
+    *last = frame;
+    buffer_append(&offline_capture, data, len);
+}
+
+// Test that rendering frame chunks on several workers emits the same bytes
+// as the live loop
+TEST(offline_matches_live) {
+    config_t config = {0};
+    static char live[1 << 20];
+    effect_func_t effects[] = {effect_matrix, effect_decrypt, effect_spotlights};
+    
+    for (int e = 0; e < 3; e++) {
+        terminal_t term = {0};
+        init_terminal(&term);
+        setup_seek_text(&term);
+        save_initial_state(&term);
+        
+        // Live loop, one frame at a time
+        size_t live_len = 0;
+        for (int frame = 0; ; frame++) {
+            int active_chars = advance_effect(&term, &config, effects[e], NULL, frame);
+            live_len += capture_output(&term, &config, live + live_len, sizeof(live) - live_len);
+            if (animation_finished(active_chars, frame)) {
+                break;
+            }
+        }
+        
+        worker_pool_t *pool = worker_pool_create(3);
+        assert(pool != NULL);
+        int last = -1;
+        offline_capture.len = 0;
+        assert(render_offline(&term, &config, effects[e], pool, 0, NULL, collect_output, &last) == 0);
+        assert(offline_capture.len == live_len);
+        assert(memcmp(offline_capture.data, live, live_len) == 0);
+        
+        worker_pool_destroy(pool);
+        cleanup_terminal(&term);
+    }
+    buffer_free(&offline_capture);
+}
+
+// Test that a recording has a v2 header and one event per frame, stamped at
+// the live frame rate
+TEST(asciicast_recording) {
+    config_t config = {0};
+    terminal_t term = {0};
+    init_terminal(&term);
+    setup_seek_text(&term);
+    save_initial_state(&term);
+    
+    char path[64];
+    snprintf(path, sizeof(path), "/tmp/tte_test_%d.cast", (int)getpid());
+    
+    asciicast_t cast;
+    assert(asciicast_open(&cast, path, 48, 12, 100) == 0);
+    assert(render_offline(&term, &config, effect_decrypt, NULL, 10, NULL, asciicast_frame, &cast) == 0);
+    assert(cast.first_frame == 10);
+    double last_time = cast.time;
+    assert(last_time > 0.5);
+    assert(asciicast_close(&cast, 1) == 0);
+    
+    FILE *file = fopen(path, "r");
+    assert(file != NULL);
+    static char line[1 << 16];
+    assert(fgets(line, sizeof(line), file) != NULL);
+    assert(strcmp(line, "{\"version\": 2, \"width\": 48, \"height\": 12, "
+                  "\"env\": {\"TERM\": \"xterm-256color\"}}\n") == 0);
+    double previous = 0.0;
+    int events = 0;
+    while (fgets(line, sizeof(line), file)) {
+        double time;
+        assert(sscanf(line, "[%lf, \"o\", \"", &time) == 1);
+        assert(time >= previous);
+        assert(strchr(line, '\033') == NULL);  // Escapes are JSON-encoded
+        previous = time;
+        events++;
+    }
+    assert(previous == last_time);
+    assert(events > 2);
+    fclose(file);
+    unlink(path);
+    cleanup_terminal(&term);
+}
+
+// Test that the LZ codec round-trips, shrinks repetitive data and rejects
+// damaged blocks
+TEST(lz_roundtrip) {
+    static char input[20000];
+    static char output[20000];
+    for (size_t i = 0; i < sizeof(input); i++) {
+        input[i] = (i % 700 < 350) ? "\033[38;5;46mtte"[i % 14] : (char)(i * 2654435761u >> 24);
+    }
+    byte_buffer_t block = {0};
+    assert(lz_compress(input, sizeof(input), &block) == 0);
+    assert(block.len < sizeof(input) * 3 / 4);
+    assert(lz_decompress(block.data, block.len, output, sizeof(output)) == 0);
+    assert(memcmp(input, output, sizeof(input)) == 0);
+    
+    // Wrong size and truncated blocks are refused
+    assert(lz_decompress(block.data, block.len, output, sizeof(output) - 1) != 0);
+    assert(lz_decompress(block.data, block.len / 2, output, sizeof(output)) != 0);
+    
+    block.len = 0;
+    assert(lz_compress(input, 0, &block) == 0);
+    assert(lz_decompress(block.data, block.len, output, 0) == 0);
+    buffer_free(&block);
+}
+
+// Test that a saved animation plays back exactly the bytes the effect emits
+TEST(saved_animation_plays_back) {
+    config_t config = {0};
+    terminal_t term = {0};
+    init_terminal(&term);
+    setup_seek_text(&term);
+    save_initial_state(&term);
+    
+    int last = -1;
+    offline_capture.len = 0;
+    assert(render_offline(&term, &config, effect_decrypt, NULL, 0, NULL, collect_output, &last) == 0);
+    
+    char path[64];
+    snprintf(path, sizeof(path), "/tmp/tte_test_%d.tte", (int)getpid());
+    for (int compress = 0; compress <= 1; compress++) {
+        anim_writer_t writer;
+        assert(anim_writer_init(&writer, term.terminal_height, term.terminal_width, 60, compress) == 0);
+        assert(render_offline(&term, &config, effect_decrypt, NULL, 0, format_delta_frame,
+                              anim_writer_frame, &writer) == 0);
+        assert(writer.keyframe_count > 1);
+        assert(anim_writer_finish(&writer, path) == 0);
+        
+        output_t played;
+        output_init_memory(&played);
+        config.offline = 1;  // No pacing
+        assert(play_animation(path, &config, &played) == 0);
+        assert(played.buffer.len == offline_capture.len);
+        assert(memcmp(played.buffer.data, offline_capture.data, played.buffer.len) == 0);
+        output_close(&played);
+        config.offline = 0;
+    }
+    
+    // Anything else is refused
+    FILE *bogus = fopen(path, "w");
+    fputs("not an animation", bogus);
+    fclose(bogus);
+    output_t nowhere;
+    output_init_null(&nowhere);
+    assert(play_animation(path, &config, &nowhere) != 0);
+    assert(nowhere.bytes == 0);
+    unlink(path);
+    buffer_free(&offline_capture);
+    cleanup_terminal(&term);
+}
+
+// Test that cache keys follow the input and options, and that eviction
+// removes the least recently used entries first
+TEST(cache_keys_and_eviction) {
+    config_t config = {0};
+    config.effect_name = "decrypt";
+    terminal_t term = {0};
+    init_terminal(&term);
+    
+    uint64_t key = cache_key(&term, &config, "hello", 5);
+    assert(key == cache_key(&term, &config, "hello", 5));
+    assert(key != cache_key(&term, &config, "hellp", 5));
+    config.seed = 3;
+    assert(key != cache_key(&term, &config, "hello", 5));
+    config.seed = 0;
+    config.no_color = 1;  // Applied at playback, not part of the frames
+    assert(key == cache_key(&term, &config, "hello", 5));
+    
+    char dir[64];
+    snprintf(dir, sizeof(dir), "/tmp/tte_cache_%d", (int)getpid());
+    assert(mkdir(dir, 0700) == 0);
+    static char block[1000];
+    char path[128];
+    for (int i = 0; i < 4; i++) {
+        snprintf(path, sizeof(path), "%s/%d.tte", dir, i);
+        FILE *file = fopen(path, "w");
+        assert(file != NULL);
+        fwrite(block, 1, sizeof(block), file);
+        fclose(file);
+        // Entry i was last used i hours ago, except that 0 is the oldest
+        struct timeval times[2];
+        gettimeofday(&times[0], NULL);
+        times[0].tv_sec -= (i == 0 ? 10 : i) * 3600;
+        times[1] = times[0];
+        assert(utimes(path, times) == 0);
+    }
+    
+    cache_evict(dir, 2500);
+    for (int i = 0; i < 4; i++) {
+        snprintf(path, sizeof(path), "%s/%d.tte", dir, i);
+        assert((access(path, F_OK) == 0) == (i == 1 || i == 2));
+        unlink(path);
+    }
+    rmdir(dir);
+    cleanup_terminal(&term);
+}
+
+// Test that a baked animation compiles on its own and plays the same bytes
+// as the live run
+TEST(baked_player_matches_live) {
+    config_t config = {0};
+    config.frame_rate = 100000;
+    config.no_final_newline = 1;
+    terminal_t term = {0};
+    init_terminal(&term);
+    setup_seek_text(&term);
+    save_initial_state(&term);
+    
+    int last = -1;
+    offline_capture.len = 0;
+    assert(render_offline(&term, &config, effect_matrix, NULL, 0, NULL, collect_output, &last) == 0);
+    
+    char source[64], binary[64], output[64], command[512];
+    snprintf(source, sizeof(source), "/tmp/tte_bake_%d.c", (int)getpid());
+    snprintf(binary, sizeof(binary), "/tmp/tte_bake_%d", (int)getpid());
+    snprintf(output, sizeof(output), "/tmp/tte_bake_%d.out", (int)getpid());
+    assert(bake_animation(&term, &config, effect_matrix, NULL, source) == 0);
+    snprintf(command, sizeof(command), "cc -std=c99 -Wall -Werror -DTTE_BAKED_MAIN %s -o %s && %s > %s",
+             source, binary, binary, output);
+    assert(system(command) == 0);
+    
+    FILE *played = fopen(output, "r");
+    assert(played != NULL);
+    static char buffer[1 << 20];
+    size_t len = fread(buffer, 1, sizeof(buffer), played);
+    fclose(played);
+    size_t prologue = sizeof(ANSI_HIDE_CURSOR) - 1;
+    size_t epilogue = sizeof(ANSI_SHOW_CURSOR) - 1;
+    assert(len == prologue + offline_capture.len + epilogue);
+    assert(memcmp(buffer, ANSI_HIDE_CURSOR, prologue) == 0);
+    assert(memcmp(buffer + prologue, offline_capture.data, offline_capture.len) == 0);
+    assert(memcmp(buffer + prologue + offline_capture.len, ANSI_SHOW_CURSOR, epilogue) == 0);
+    
+    unlink(source);
+    unlink(binary);
+    unlink(output);
+    buffer_free(&offline_capture);
+    cleanup_terminal(&term);
+}
+
+// Collect every frame a context produces; run on its own thread
+typedef struct {
+    const char *effect;
+    byte_buffer_t out;
+    int frames;
+} libtte_run_t;
+
+static void *run_context(void *arg) {
+    libtte_run_t *run = arg;
+    static const char text[] = "Embedded\n  effects in\nany TUI";
+    const char *options[] = {"--seed", "11"};
+    tte_ctx *ctx = tte_create(run->effect, 60, 16);
+    assert(ctx != NULL);
+    assert(tte_set_options(ctx, 2, options) == TTE_OK);
+    assert(tte_load_text(ctx, text, sizeof(text) - 1) == TTE_OK);
+    assert(tte_set_options(ctx, 2, options) == TTE_ERROR);
+    
+    char small[8];
+    char frame[1 << 16];
+    size_t len;
+    int result;
+    while ((result = tte_step(ctx, small, sizeof(small), &len)) != TTE_DONE) {
+        if (result == TTE_SHORT_BUFFER) {
+            // The same frame comes back once there is room for it
+            assert(len > sizeof(small));
+            assert(tte_step(ctx, frame, sizeof(frame), &len) == TTE_OK);
+            buffer_append(&run->out, frame, len);
+        } else {
+            assert(result == TTE_OK);
+            buffer_append(&run->out, small, len);
+        }
+        run->frames++;
+    }
+    tte_destroy(ctx);
+    return NULL;
+}
+
+// Test that contexts driven from several threads at once give the same
+// frames as each one alone
+// Every frame of a context's animation, back to back
+static void libtte_render(tte_ctx *ctx, byte_buffer_t *out) {
+    static const char text[] = "Options\napplied";
+    static char frame[1 << 16];
+    size_t len;
+    assert(tte_load_text(ctx, text, sizeof(text) - 1) == TTE_OK);
+    while (tte_step(ctx, frame, sizeof(frame), &len) == TTE_OK) {
+        buffer_append(out, frame, len);
+    }
+    tte_destroy(ctx);
+}
+
+TEST(libtte_concurrent_contexts) {
+    assert(tte_create("no-such-effect", 80, 24) == NULL);
+    
+    // Options the library cannot take are refused, none of them acted on
+    tte_ctx *ctx = tte_create("wipe", 80, 24);
+    const char *help[] = {"--help"};
+    const char *unknown[] = {"--seed", "3", "--sparkle"};
+    assert(tte_set_options(ctx, 1, help) == TTE_ERROR);
+    assert(tte_set_options(ctx, 3, unknown) == TTE_ERROR);
+    byte_buffer_t refused = {0}, plain = {0};
+    libtte_render(ctx, &refused);
+    libtte_render(tte_create("wipe", 80, 24), &plain);
+    assert(refused.len == plain.len && memcmp(refused.data, plain.data, plain.len) == 0);
+    
+    // Option strings may be gone by the time the text is loaded
+    char colors[32];
+    strcpy(colors, "#ff0000,#0000ff");
+    const char *temporary[] = {"--gradient-colors", colors};
+    const char *literal[] = {"--gradient-colors", "#ff0000,#0000ff"};
+    byte_buffer_t a = {0}, b = {0};
+    ctx = tte_create("wipe", 80, 24);
+    assert(tte_set_options(ctx, 2, temporary) == TTE_OK);
+    strcpy(colors, "garbage");
+    libtte_render(ctx, &a);
+    ctx = tte_create("wipe", 80, 24);
+    assert(tte_set_options(ctx, 2, literal) == TTE_OK);
+    libtte_render(ctx, &b);
+    assert(a.len == b.len && memcmp(a.data, b.data, a.len) == 0);
+    assert(a.len != plain.len || memcmp(a.data, plain.data, a.len) != 0);
+    buffer_free(&refused);
+    buffer_free(&plain);
+    buffer_free(&a);
+    buffer_free(&b);
+    
+    const char *effects[] = {"decrypt", "matrix", "decrypt", "swarm"};
+    libtte_run_t alone[4] = {{0}};
+    libtte_run_t together[4] = {{0}};
+    pthread_t threads[4];
+    for (int i = 0; i < 4; i++) {
+        alone[i].effect = together[i].effect = effects[i];
+        run_context(&alone[i]);
+        assert(alone[i].frames > MIN_FRAMES);
+    }
+    for (int i = 0; i < 4; i++) {
+        assert(pthread_create(&threads[i], NULL, run_context, &together[i]) == 0);
+    }
+    for (int i = 0; i < 4; i++) {
+        pthread_join(threads[i], NULL);
+        assert(together[i].frames == alone[i].frames);
+        assert(together[i].out.len == alone[i].out.len);
+        assert(memcmp(together[i].out.data, alone[i].out.data, alone[i].out.len) == 0);
+        buffer_free(&alone[i].out);
+        buffer_free(&together[i].out);
+    }
+}
+
+// Test that tte_tick renders the frame due at the given time, reports when
+// the next one is due, and skips the static tail of a settled animation
+TEST(libtte_event_loop_ticks) {
+    static const char text[] = "Event\nloop";
+    char frame[1 << 16];
+    size_t len;
+    tte_ctx *ctx = tte_create("wipe", 40, 8);
+    assert(tte_load_text(ctx, text, sizeof(text) - 1) == TTE_OK);
+    int steps = 0;
+    static char first[1 << 16];
+    size_t first_len = 0;
+    while (tte_step(ctx, frame, sizeof(frame), &len) == TTE_OK) {
+        if (steps++ == 0) {
+            memcpy(first, frame, len);
+            first_len = len;
+        }
+    }
+    tte_destroy(ctx);
+    
+    ctx = tte_create("wipe", 40, 8);
+    assert(tte_load_text(ctx, text, sizeof(text) - 1) == TTE_OK);
+    long long period = 1000000000LL / tte_frame_rate(ctx);
+    struct timespec now = {1000, 0};
+    tte_tick_t tick;
+    assert(tte_tick(ctx, &now, frame, sizeof(frame), &tick) == TTE_OK);
+    assert(tick.changed && tick.len > 0);
+    assert(tick.next.tv_sec == 1000 && tick.next.tv_nsec >= period && tick.next.tv_nsec <= period + 1);
+    
+    // Too early: nothing is drawn and the deadline stays put
+    struct timespec early = {1000, 1};
+    struct timespec deadline = tick.next;
+    assert(tte_tick(ctx, &early, frame, sizeof(frame), &tick) == TTE_OK);
+    assert(tick.len == 0 && !tick.changed);
+    assert(tick.next.tv_sec == deadline.tv_sec && tick.next.tv_nsec == deadline.tv_nsec);
+    
+    // Waking only at each deadline takes fewer wakeups than frames
+    int wakeups = 1;
+    long long longest = 0;
+    int result;
+    now = tick.next;
+    while ((result = tte_tick(ctx, &now, frame, sizeof(frame), &tick)) == TTE_OK) {
+        long long gap = (tick.next.tv_sec - now.tv_sec) * 1000000000LL + tick.next.tv_nsec - now.tv_nsec;
+        longest = gap > longest ? gap : longest;
+        now = tick.next;
+        wakeups++;
+    }
+    assert(result == TTE_DONE);
+    assert(wakeups < steps);
+    assert(longest > 10 * period);
+    tte_destroy(ctx);
+    
+    // A host that wakes up late gets the latest frame, not a backlog
+    ctx = tte_create("wipe", 40, 8);
+    assert(tte_load_text(ctx, text, sizeof(text) - 1) == TTE_OK);
+    now.tv_sec = 50;
+    now.tv_nsec = 0;
+    assert(tte_tick(ctx, &now, frame, sizeof(frame), &tick) == TTE_OK);
+    now.tv_sec = 60;
+    assert(tte_tick(ctx, &now, frame, sizeof(frame), &tick) == TTE_OK);
+    assert(tick.changed && tick.len > 0);
+    assert(tte_tick(ctx, &now, frame, sizeof(frame), &tick) == TTE_DONE);
+    
+    // Loading text again rewinds to the first frame on a fresh clock
+    assert(tte_load_text(ctx, text, sizeof(text) - 1) == TTE_OK);
+    now.tv_sec = 90;
+    assert(tte_tick(ctx, &now, frame, sizeof(frame), &tick) == TTE_OK);
+    assert(tick.len == first_len && memcmp(frame, first, first_len) == 0);
+    assert(tick.next.tv_sec == 90 && tick.next.tv_nsec >= period && tick.next.tv_nsec <= period + 1);
+    tte_destroy(ctx);
+}
+
+// Serve the probe from the second serve_listen and two requests
+static void *serve_requests(void *arg) {
+    int sock = *(int *)arg;
+    for (int i = 0; i < 3; i++) {
+        int conn = accept(sock, NULL, NULL);
+        assert(conn >= 0);
+        serve_client(conn);
+    }
+    return NULL;
+}
+
+// Test that a daemon draws on the descriptor a client hands it exactly
+// what the client would have drawn itself
+TEST(daemon_draws_on_client_fd) {
+    char path[64];
+    snprintf(path, sizeof(path), "/tmp/tte-serve-%d.sock", (int)getpid());
+    static const char text[] = "Served\nfrom a daemon";
+    byte_buffer_t input = {0};
+    buffer_append(&input, text, sizeof(text) - 1);
+    char *argv[] = {"tte-c", "--connect", path, "--seed", "5", "--offline", "--no-final-newline", "rings"};
+    int status = -1;
+    
+    // No daemon yet: the caller is told to draw it itself
+    assert(serve_connect(path, 8, argv, &input, STDOUT_FILENO, &status) == -1);
+    
+    int sock = serve_listen(path);
+    assert(sock >= 0);
+    assert(serve_listen(path) == -1 && errno == EADDRINUSE);
+    pthread_t thread;
+    assert(pthread_create(&thread, NULL, serve_requests, &sock) == 0);
+    
+    FILE *served = tmpfile();
+    FILE *local = tmpfile();
+    assert(served && local);
+    assert(serve_connect(path, 8, argv, &input, fileno(served), &status) == 0);
+    assert(status == 0);
+    char *help[] = {"tte-c", "--help", "rings"};
+    assert(serve_connect(path, 3, help, &input, fileno(served), &status) == 0);
+    assert(status == 2);
+    pthread_join(thread, NULL);
+    close(sock);
+    unlink(path);
+    
+    config_t config;
+    init_config(&config);
+    parse_args(8, argv, &config);
+    assert(serve_animation(&config, &input, fileno(local)) == 0);
+    byte_buffer_t a = {0}, b = {0};
+    rewind(served);
+    rewind(local);
+    buffer_read_file(&a, served);
+    buffer_read_file(&b, local);
+    assert(a.len > 0 && a.len == b.len && memcmp(a.data, b.data, a.len) == 0);
+    
+    // A client that goes away stops the drawing on its terminal
+    int pair[2];
+    assert(socketpair(AF_UNIX, SOCK_STREAM, 0, pair) == 0);
+    init_config(&config);
+    parse_args(8, argv, &config);
+    config.offline = 0;
+    config.frame_rate = 1000;
+    config.hangup_fd = pair[0];
+    assert(!serve_hung_up(&config));
+    close(pair[1]);
+    assert(serve_hung_up(&config));
+    FILE *abandoned = tmpfile();
+    assert(serve_animation(&config, &input, fileno(abandoned)) == 0);
+    assert(lseek(fileno(abandoned), 0, SEEK_END) < (off_t)b.len);
+    close(pair[0]);
+    fclose(abandoned);
+    
+    fclose(served);
+    fclose(local);
+    buffer_free(&a);
+    buffer_free(&b);
+    buffer_free(&input);
+}
+
+// Test that frames published to the shared-memory ring read back as the
+// composited screen, and that readers only see new frames
+TEST(shm_framebuffer_export) {
+    char name[64];
+    snprintf(name, sizeof(name), "tte-test-%d", (int)getpid());
+    terminal_t term = {0};
+    init_terminal(&term);
+    setup_seek_text(&term);
+    config_t config;
+    init_config(&config);
+    
+    shm_export_t shm;
+    assert(shm_export_open(&shm, name, 24, 80, 60) == 0);
+    int fd = shm_open(shm.name, O_RDONLY, 0);
+    assert(fd >= 0);
+    const tte_shm_header_t *reader = mmap(NULL, shm.size, PROT_READ, MAP_SHARED, fd, 0);
+    assert(reader != MAP_FAILED);
+    close(fd);
+    assert(memcmp(reader->magic, TTE_SHM_MAGIC, 4) == 0);
+    assert(reader->rows == 24 && reader->cols == 80 && reader->frame_rate == 60);
+    
+    tte_shm_cell_t *cells = malloc(24 * 80 * sizeof(tte_shm_cell_t));
+    uint64_t seen = 0;
+    assert(tte_shm_read(reader, cells, &seen) == 0);
+    effect_func_t func = get_effect_function("decrypt");
+    for (int frame = 0; frame < 12; frame++) {
+        advance_effect(&term, &config, func, NULL, frame);
+        if (!composite_frame(&term, &config)) {
+            continue;
+        }
+        shm_export_frame(&shm, term.fb, frame);
+        assert(tte_shm_read(reader, cells, &seen) == 1);
+        assert(tte_shm_read(reader, cells, &seen) == 0);
+        assert(seen == reader->published);
+        assert(tte_shm_slot(reader, seen - 1)->frame == (uint32_t)frame);
+        for (int row = 0; row < 24; row++) {
+            for (int col = 0; col < 80; col++) {
+                tte_shm_cell_t *cell = &cells[row * 80 + col];
+                assert(cell->glyph == (unsigned char)term.fb->screen[row][col]);
+                assert(!!(cell->attrs & TTE_SHM_FG) == (term.fb->screen_fg[row][col] >= 0));
+                if (cell->attrs & TTE_SHM_FG) {
+                    assert(cell->fg == term.fb->screen_fg[row][col]);
+                }
+                assert(!!(cell->attrs & TTE_SHM_BOLD) == !!term.fb->screen_bold[row][col]);
+            }
+        }
+    }
+    assert(seen >= 2);
+    
+    // Closing marks the end; a reader still mapping it keeps the last frame
+    char path[sizeof(shm.name)];
+    strcpy(path, shm.name);
+    shm_export_close(&shm);
+    assert(reader->flags & TTE_SHM_DONE);
+    assert(shm_open(path, O_RDONLY, 0) < 0 && errno == ENOENT);
+    munmap((void *)reader, shm.size);
+    free(cells);
+    cleanup_terminal(&term);
+}
+
+// Test that every output backend is handed the same bytes, and that the
+// null sink still counts them
+TEST(output_backends) {
+    config_t config;
+    init_config(&config);
+    config.offline = 1;
+    config.seed = 3;
+    const effect_info_t *effect = find_effect("slide");
+    byte_buffer_t input = {0};
+    char path[64];
+    snprintf(path, sizeof(path), "/tmp/tte-sink-%d.out", (int)getpid());
+    
+    output_t memory, null, file;
+    output_init_memory(&memory);
+    output_init_null(&null);
+    assert(output_init_file(&file, path) == 0);
+    output_t *outputs[] = {&memory, &null, &file};
+    for (int i = 0; i < 3; i++) {
+        terminal_t term = {0};
+        init_terminal(&term);
+        setup_seek_text(&term);
+        save_initial_state(&term);
+        show_animation(&term, &config, effect, NULL, &input, outputs[i]);
+        cleanup_terminal(&term);
+    }
+    assert(memory.bytes > 0 && memory.buffer.len == memory.bytes);
+    assert(null.bytes == memory.bytes && null.writes == memory.writes);
+    assert(file.bytes == memory.bytes);
+    assert(output_close(&file) == 0);
+    
+    FILE *written = fopen(path, "r");
+    byte_buffer_t contents = {0};
+    buffer_read_file(&contents, written);
+    fclose(written);
+    unlink(path);
+    assert(contents.len == memory.buffer.len);
+    assert(memcmp(contents.data, memory.buffer.data, contents.len) == 0);
+    buffer_free(&contents);
+    output_close(&memory);
+    output_close(&null);
+    
+    // Unknown backends are refused
+    output_t bogus;
+    assert(output_init_sink(&bogus, "carrier-pigeon") != 0);
+    assert(output_init_sink(&bogus, "null") == 0 && bogus.ops->name[0] == 'n');
+}
+
+// Put the characters of a stream on a rows x cols screen, following its
+// cursor moves and skipping every other escape sequence
+static void replay_screen(const byte_buffer_t *stream, char *screen, int rows, int cols) {
+    int row = 0, col = 0;
+    memset(screen, ' ', rows * cols);
+    for (size_t i = 0; i < stream->len; i++) {
+        if (stream->data[i] == '\033' && i + 1 < stream->len && stream->data[i + 1] == '[') {
+            size_t end = i + 2;
+            while (end < stream->len && (stream->data[end] < '@' || stream->data[end] > '~')) {
+                end++;
+            }
+            if (end < stream->len && stream->data[end] == 'H' &&
+                sscanf(stream->data + i + 2, "%d;%d", &row, &col) == 2) {
+                row--;
+                col--;
+            }
+            i = end;
+        } else if (stream->data[i] != '\n') {
+            if (row >= 0 && row < rows && col >= 0 && col < cols) {
+                screen[row * cols + col] = stream->data[i];
+            }
+            col++;
+        }
+    }
+}
+
+typedef struct {
+    int fd;
+    byte_buffer_t data;
+} slow_reader_t;
+
+static void *read_slowly(void *arg) {
+    slow_reader_t *reader = arg;
+    char chunk[512];
+    ssize_t n;
+    while ((n = read(reader->fd, chunk, sizeof(chunk))) > 0) {
+        buffer_append(&reader->data, chunk, n);
+        nanosleep(&(struct timespec){0, 2000000}, NULL);
+    }
+    return NULL;
+}
+
+// Test that a target fast enough for every frame gets exactly what a local
+// run draws, and that a slow one drops frames yet ends on the same screen
+TEST(fanout_to_many_outputs) {
+    byte_buffer_t input = {0};
+    for (int line = 0; line < 20; line++) {
+        static const char text[] = "Fan-out draws one animation on every lobby screen at once\n";
+        buffer_append(&input, text, sizeof(text) - 1);
+    }
+    char path[64], mono_path[80], mono[96], slow[32];
+    snprintf(path, sizeof(path), "/tmp/tte-fanout-%d.out", (int)getpid());
+    snprintf(mono_path, sizeof(mono_path), "%s.mono", path);
+    snprintf(mono, sizeof(mono), "%s:no-color", mono_path);
+    FILE *created[] = {fopen(path, "w"), fopen(mono_path, "w")};
+    assert(created[0] && created[1]);
+    fclose(created[0]);
+    fclose(created[1]);
+    int fds[2];
+    assert(pipe(fds) == 0);
+    slow_reader_t reader = {fds[0], {0}};
+    pthread_t thread;
+    assert(pthread_create(&thread, NULL, read_slowly, &reader) == 0);
+    
+    config_t config;
+    init_config(&config);
+    snprintf(slow, sizeof(slow), "/dev/fd/%d", fds[1]);
+    char *argv[] = {"tte-c", "--output", path, "--output", mono, "--output", slow,
+                    "--seed", "9", "--frame-rate", "1000", "--no-final-newline", "decrypt"};
+    parse_args(13, argv, &config);
+    assert(config.output_count == 3);
+    assert(fanout_animation(&config, find_effect("decrypt"), &input) == 0);
+    close(fds[1]);
+    pthread_join(thread, NULL);
+    close(fds[0]);
+    
+    // The same animation drawn locally on an 80x24 file
+    FILE *local = tmpfile();
+    config.offline = 1;
+    assert(serve_animation(&config, &input, fileno(local)) == 0);
+    byte_buffer_t expected = {0}, drawn = {0}, plain = {0};
+    rewind(local);
+    buffer_read_file(&expected, local);
+    fclose(local);
+    FILE *written = fopen(path, "r");
+    buffer_read_file(&drawn, written);
+    fclose(written);
+    unlink(path);
+    written = fopen(mono_path, "r");
+    buffer_read_file(&plain, written);
+    fclose(written);
+    unlink(mono_path);
+    assert(drawn.len == expected.len && memcmp(drawn.data, expected.data, drawn.len) == 0);
+    
+    // Colorless and frame-dropping targets still end on the same screen
+    static char screen[24 * 80], other[24 * 80];
+    replay_screen(&drawn, screen, 24, 80);
+    replay_screen(&plain, other, 24, 80);
+    buffer_append(&plain, "", 1);
+    assert(plain.len < drawn.len && !strstr(plain.data, "38;5;"));
+    assert(memcmp(screen, other, sizeof(screen)) == 0);
+    replay_screen(&reader.data, other, 24, 80);
+    assert(reader.data.len > 0 && reader.data.len < drawn.len);
+    assert(memcmp(screen, other, sizeof(screen)) == 0);
+    buffer_free(&expected);
+    buffer_free(&drawn);
+    buffer_free(&plain);
+    buffer_free(&reader.data);
+    buffer_free(&input);
+}
+
+// Test that the tiles of a wall together show what one terminal the size
+// of the whole wall would
+TEST(video_wall_tiles) {
+    static const char text[] = "One canvas\nspread over a wall of two terminals\n";
+    byte_buffer_t input = {0};
+    buffer_append(&input, text, sizeof(text) - 1);
+    char left[64], right[64];
+    snprintf(left, sizeof(left), "/tmp/tte-wall-%d.left", (int)getpid());
+    snprintf(right, sizeof(right), "/tmp/tte-wall-%d.right", (int)getpid());
+    FILE *created[] = {fopen(left, "w"), fopen(right, "w")};
+    assert(created[0] && created[1]);
+    fclose(created[0]);
+    fclose(created[1]);
+    
+    char *argv[] = {"tte-c", "--wall", "2x1", "--output", left, "--output", right, "--seed", "4",
+                    "--frame-rate", "1000", "--no-final-newline", "expand"};
+    config_t config;
+    init_config(&config);
+    parse_args(13, argv, &config);
+    assert(config.wall_columns == 2 && config.wall_rows == 1);
+    
+    // Sizes that are malformed or need more terminals than one run can hold
+    const char *invalid[] = {"0x3", "5x5", "2", "2x1x", "65536x65536"};
+    for (size_t i = 0; i < sizeof(invalid) / sizeof(invalid[0]); i++) {
+        config_t bad;
+        init_config(&bad);
+        char *bad_argv[] = {"tte-c", "--wall", (char *)invalid[i]};
+        assert(parse_args(3, bad_argv, &bad) == -1);
+        assert(bad.wall_columns == 0 && bad.wall_rows == 0);
+    }
+    assert(fanout_animation(&config, find_effect("expand"), &input) == 0);
+    config.output_count = 1;
+    assert(fanout_animation(&config, find_effect("expand"), &input) != 0);  // Too few terminals
+    
+    // The whole wall drawn at once
+    terminal_t term = {0};
+    assert(layout_input(&term, &config, &input, 160, 24) == 0);
+    output_t wall;
+    output_init_memory(&wall);
+    config.offline = 1;
+    show_animation(&term, &config, find_effect("expand"), NULL, &input, &wall);
+    cleanup_terminal(&term);
+    
+    static char whole[24 * 160], tile[24 * 80];
+    replay_screen(&wall.buffer, whole, 24, 160);
+    const char *paths[] = {left, right};
+    for (int t = 0; t < 2; t++) {
+        byte_buffer_t drawn = {0};
+        FILE *written = fopen(paths[t], "r");
+        buffer_read_file(&drawn, written);
+        fclose(written);
+        unlink(paths[t]);
+        replay_screen(&drawn, tile, 24, 80);
+        int shown = 0;
+        for (int row = 0; row < 24; row++) {
+            assert(memcmp(tile + row * 80, whole + row * 160 + t * 80, 80) == 0);
+            for (int col = 0; col < 80; col++) {
+                shown += tile[row * 80 + col] != ' ';
+            }
+        }
+        assert(shown > 0);  // The text spans both tiles
+        buffer_free(&drawn);
+    }
+    output_close(&wall);
+    buffer_free(&input);
+}
+
+// Read a whole file into a buffer and remove it
+static void read_and_unlink(const char *path, byte_buffer_t *out) {
+    FILE *file = fopen(path, "r");
+    assert(file);
+    buffer_read_file(out, file);
+    fclose(file);
+    unlink(path);
+}
+
+// Test that batch jobs, run side by side on the pool, write what a single
+// headless run of the same job would, and that bad lines are reported
+// One batch job's gradient, resolved over and over
+typedef struct {
+    char *colors;
+    rgb_color_t expect[3];
+    int mismatches;
+} gradient_job_t;
+
+static void *resolve_gradients(void *arg) {
+    gradient_job_t *job = arg;
+    for (int i = 0; i < 5000; i++) {
+        config_t config;
+        init_config(&config);
+        config.gradient_colors_string = job->colors;
+        resolve_gradient(&config);
+        for (int k = 0; k < 3; k++) {
+            rgb_color_t *c = &config.gradient_stops[k];
+            job->mismatches += config.gradient_count != 3 || c->r != job->expect[k].r ||
+                               c->g != job->expect[k].g || c->b != job->expect[k].b;
+        }
+    }
+    return NULL;
+}
+
+// Test that jobs with their own --gradient-colors, resolved at the same
+// time on different threads, each get exactly their own stops
+TEST(concurrent_gradient_colors) {
+    gradient_job_t jobs[2] = {
+        {"#ff0000,#00ff00,#0000ff", {{255, 0, 0}, {0, 255, 0}, {0, 0, 255}}, 0},
+        {"cyan,#123456,black", {{0, 255, 255}, {0x12, 0x34, 0x56}, {0, 0, 0}}, 0},
+    };
+    pthread_t threads[2];
+    for (int i = 0; i < 2; i++) {
+        assert(pthread_create(&threads[i], NULL, resolve_gradients, &jobs[i]) == 0);
+    }
+    for (int i = 0; i < 2; i++) {
+        pthread_join(threads[i], NULL);
+        assert(jobs[i].mismatches == 0);
+    }
+}
+
+TEST(batch_manifest_jobs) {
+    char dir[64], path[128], manifest[128];
+    snprintf(dir, sizeof(dir), "/tmp/tte-batch-%d", (int)getpid());
+    assert(mkdir(dir, 0700) == 0);
+    snprintf(path, sizeof(path), "%s/banner.txt", dir);
+    FILE *file = fopen(path, "w");
+    fputs("Gallery\npreview\n", file);
+    fclose(file);
+    snprintf(manifest, sizeof(manifest), "%s/jobs", dir);
+    file = fopen(manifest, "w");
+    fprintf(file, "# banner x effect\n\n");
+    fprintf(file, "%s/banner.txt rain %s/rain.cast\n", dir, dir);
+    fprintf(file, "%s/banner.txt wipe %s/wipe.cast --seed 8\n", dir, dir);
+    fprintf(file, "%s/banner.txt slide %s/slide.anim --record-size 40x8\n", dir, dir);
+    fclose(file);
+    
+    char *argv[] = {"tte-c", "--threads", "3", "--seed", "2"};
+    config_t base;
+    init_config(&base);
+    parse_args(5, argv, &base);
+    assert(run_batch(&base, manifest) == 0);
+    
+    // The second job, rendered alone
+    const char *others[] = {"rain.cast", "slide.anim"};
+    char output[128], alone[128];
+    snprintf(output, sizeof(output), "%s/wipe.cast", dir);
+    snprintf(alone, sizeof(alone), "%s/alone.cast", dir);
+    config_t config;
+    init_config(&config);
+    config.seed = 8;
+    config.effect_name = "wipe";
+    config.record_path = alone;
+    resolve_gradient(&config);
+    byte_buffer_t input = {0};
+    buffer_append(&input, "Gallery\npreview\n", 16);
+    terminal_t term = {0};
+    assert(layout_input(&term, &config, &input, config.record_width, config.record_height) == 0);
+    assert(render_headless(&term, &config, find_effect("wipe"), NULL) == 0);
+    cleanup_terminal(&term);
+    byte_buffer_t a = {0}, b = {0};
+    read_and_unlink(output, &a);
+    read_and_unlink(alone, &b);
+    assert(a.len > 0 && a.len == b.len && memcmp(a.data, b.data, a.len) == 0);
+    buffer_free(&a);
+    buffer_free(&b);
+    for (int i = 0; i < 2; i++) {
+        struct stat st;
+        snprintf(output, sizeof(output), "%s/%s", dir, others[i]);
+        assert(stat(output, &st) == 0 && st.st_size > 0);
+        unlink(output);
+    }
+    
+    // A line naming no output, an unknown effect or a missing input fails the batch
+    file = fopen(manifest, "w");
+    fprintf(file, "%s/banner.txt rain\n%s/banner.txt sparkle %s/x.cast\n", dir, dir, dir);
+    fprintf(file, "%s/missing.txt rain %s/x.cast\n", dir, dir);
+    fclose(file);
+    assert(run_batch(&base, manifest) != 0);
+    unlink(manifest);
+    unlink(path);
+    assert(rmdir(dir) == 0);
+    buffer_free(&input);
+}
+
+TEST(frame_stats) {
+    // Draw a banner twice, the second time collecting stats
+    byte_buffer_t drawn[2] = {{0}};
+    stats_t stats;
+    stats_init(&stats);
+    int frames = 0;
+    for (int pass = 0; pass < 2; pass++) {
+        config_t config;
+        init_config(&config);
+        config.seed = 4;
+        config.effect_name = "decrypt";
+        config.background_effect = BACKGROUND_STARS;
+        config.stats = pass ? &stats : NULL;
+        resolve_gradient(&config);
+        byte_buffer_t input = {0};
+        buffer_append(&input, "Stats\n", 6);
+        terminal_t term = {0};
+        assert(layout_input(&term, &config, &input, 40, 8) == 0);
+        output_t out;
+        output_init_memory(&out);
+        frames = 0;
+        for (int frame = 0; ; frame++, frames++) {
+            int active = advance_effect(&term, &config, find_effect("decrypt")->func, NULL, frame);
+            render_frame_to(&term, &config, &out);
+            if (animation_finished(active, frame)) {
+                frames++;
+                break;
+            }
+        }
+        drawn[pass] = out.buffer;
+        if (pass) {
+            double bytes = 0;
+            for (size_t i = 0; i < stats.series[STAT_BYTES].count; i++) {
+                bytes += stats.series[STAT_BYTES].samples[i];
+            }
+            assert(bytes == (double)out.bytes);
+        }
+        cleanup_terminal(&term);
+        buffer_free(&input);
+    }
+    
+    // Collecting changes nothing drawn
+    assert(drawn[0].len == drawn[1].len && memcmp(drawn[0].data, drawn[1].data, drawn[0].len) == 0);
+    buffer_free(&drawn[0]);
+    buffer_free(&drawn[1]);
+    
+    // Every frame is stepped and composited; every frame drawn is encoded,
+    // counted and written once
+    assert((int)stats.series[STAT_EFFECT].count == frames);
+    assert(stats.series[STAT_COMPOSITE].count == stats.series[STAT_EFFECT].count);
+    assert(stats.series[STAT_BACKGROUND].count > 0);
+    assert(stats.series[STAT_GRADIENT].count > 0);
+    size_t drawn_frames = stats.series[STAT_ENCODE].count;
+    assert(drawn_frames > 0 && drawn_frames <= (size_t)frames);
+    assert(stats.series[STAT_WRITE].count == drawn_frames);
+    assert(stats.series[STAT_SGR].count == drawn_frames && stats.series[STAT_CELLS].count == drawn_frames);
+    
+    // Offline chunks on several workers measure each frame once: not the
+    // frames re-stepped at chunk boundaries, nor chunks past the end
+    size_t offline_counts[2][STAT_SERIES];
+    worker_pool_t *pool = worker_pool_create(4);
+    for (int run = 0; run < 2; run++) {
+        stats_t collected;
+        stats_init(&collected);
+        config_t config;
+        init_config(&config);
+        config.stats = &collected;
+        terminal_t term = {0};
+        init_terminal(&term);
+        setup_seek_text(&term);
+        save_initial_state(&term);
+        int last = -1;
+        assert(render_offline(&term, &config, effect_beams, run ? pool : NULL, 0, NULL, collect_output, &last) == 0);
+        for (int i = 0; i < STAT_SERIES; i++) {
+            offline_counts[run][i] = collected.series[i].count;
+        }
+        cleanup_terminal(&term);
+        stats_free(&collected);
+        buffer_free(&offline_capture);
+    }
+    worker_pool_destroy(pool);
+    assert(memcmp(offline_counts[0], offline_counts[1], sizeof(offline_counts[0])) == 0);
+    
+    // A deadline already gone by is reported as missed
+    struct timespec epoch;
+    clock_gettime(CLOCK_MONOTONIC, &epoch);
+    epoch.tv_sec -= 1;
+    assert(sleep_until_frame(&epoch, 1, 60) == 1);
+    
+    // The JSON report
+    char path[64];
+    snprintf(path, sizeof(path), "/tmp/tte-stats-%d.json", (int)getpid());
+    config_t config;
+    init_config(&config);
+    config.stats_format = STATS_JSON;
+    config.stats_path = path;
+    assert(stats_report(&stats, &config) == 0);
+    byte_buffer_t report = {0};
+    read_and_unlink(path, &report);
+    buffer_append(&report, "", 1);
+    char expect[64];
+    snprintf(expect, sizeof(expect), "{\"frames\": %d, \"missed_deadlines\": 0, ", frames);
+    assert(strncmp(report.data, expect, strlen(expect)) == 0);
+    assert(strstr(report.data, "\"encode_ms\": {\"samples\": ") && strstr(report.data, "\"p99\": "));
+    buffer_free(&report);
+    stats_free(&stats);
+}
+
 int main() {
     printf("tte-c Unit Tests\n");
     printf("================\n");
@@ -783,6 +2308,34 @@ int main() {
     RUN_TEST(interpolate_gradient_edge_cases);
     RUN_TEST(command_line_segfault_regression);
     RUN_TEST(background_rendering_safety);
+    RUN_TEST(dirty_tile_tracking);
+    RUN_TEST(reveal_timeline_queue);
+    RUN_TEST(sweep_mask_primitives);
+    RUN_TEST(lane_state_tables);
+    RUN_TEST(fast_trig_accuracy);
+    RUN_TEST(easing_lut_lookup);
+    RUN_TEST(counter_based_random);
+    RUN_TEST(worker_pool_matches_serial);
+    RUN_TEST(banded_encoding_matches_serial);
+    RUN_TEST(frame_pipeline_matches_direct);
+    RUN_TEST(frame_lookahead_pacing);
+    RUN_TEST(seek_matches_stepping);
+    RUN_TEST(offline_matches_live);
+    RUN_TEST(asciicast_recording);
+    RUN_TEST(lz_roundtrip);
+    RUN_TEST(saved_animation_plays_back);
+    RUN_TEST(cache_keys_and_eviction);
+    RUN_TEST(baked_player_matches_live);
+    RUN_TEST(libtte_concurrent_contexts);
+    RUN_TEST(libtte_event_loop_ticks);
+    RUN_TEST(daemon_draws_on_client_fd);
+    RUN_TEST(shm_framebuffer_export);
+    RUN_TEST(output_backends);
+    RUN_TEST(fanout_to_many_outputs);
+    RUN_TEST(video_wall_tiles);
+    RUN_TEST(batch_manifest_jobs);
+    RUN_TEST(concurrent_gradient_colors);
+    RUN_TEST(frame_stats);
     RUN_TEST(performance_comparison);
     
     printf("\nAll tests passed! ✅\n");